@@ -0,0 +1,46 @@
+/******************************************************************************
+ * File Name    : allocationcounter.cpp
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Opt-In Per Thread Counting Of Heap Allocations
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#include "allocationcounter.h"
+
+static thread_local unsigned threadScopes = 0;
+static thread_local uint64_t threadAllocations = 0;
+static thread_local uint64_t threadAllocatedBytes = 0;
+
+AllocationCounter::Scope::Scope()
+{
+    threadScopes++;
+}
+
+AllocationCounter::Scope::~Scope()
+{
+    threadScopes--;
+}
+
+bool AllocationCounter::isEnabled()
+{
+    return threadScopes > 0;
+}
+
+uint64_t AllocationCounter::allocations()
+{
+    return threadAllocations;
+}
+
+uint64_t AllocationCounter::allocatedBytes()
+{
+    return threadAllocatedBytes;
+}
+
+void AllocationCounter::count(size_t size)
+{
+    if (threadScopes > 0) {
+        threadAllocations++;
+        threadAllocatedBytes += size;
+    }
+}
@@ -0,0 +1,45 @@
+/******************************************************************************
+ * File Name    : allocationcounter.h
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Opt-In Per Thread Counting Of Heap Allocations
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Counts the operator new calls of each thread while counting is enabled on
+// that thread, so runs on other threads neither see nor change it. The
+// counts come from the operators in allocationhooks.cpp, which only the
+// executables link. Without them every count stays zero. Allocations made
+// with malloc, such as the ones of liblzma, are not seen.
+class AllocationCounter
+{
+public:
+    // Enables counting for the calling thread while the scope lives. Scopes
+    // may nest.
+    class Scope
+    {
+    public:
+        Scope();
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+    static bool isEnabled();
+
+    // Totals of the calling thread while counting was enabled
+    static uint64_t allocations();
+    static uint64_t allocatedBytes();
+
+    // Called by the replaced operator new for every allocation
+    static void count(size_t size);
+};
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,63 @@
+/******************************************************************************
+ * File Name    : allocationhooks.cpp
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Replaced Global Operator New And Delete For The Executables
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#include "allocationcounter.h"
+
+#include <cstdlib>
+#include <new>
+
+// Linked into the executables only, so a program using the core library
+// keeps its own allocator. The array and nothrow forms of the standard
+// library forward to these, so they cover every allocation made with new.
+void *operator new(size_t size)
+{
+    AllocationCounter::count(size);
+    void *pointer = std::malloc(size ? size : 1);
+
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+
+    return pointer;
+}
+
+void *operator new(size_t size, std::align_val_t alignment)
+{
+    AllocationCounter::count(size);
+    size_t align = static_cast<size_t>(alignment);
+    // aligned_alloc takes only whole multiples of the alignment
+    void *pointer = std::aligned_alloc(align, (size + align - 1) / align * align + (size ? 0 : align));
+
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+
+    return pointer;
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+// Sized deletes are replaced too, so they free with the replaced forms
+// whatever the standard library does
+void operator delete(void *pointer, size_t) noexcept
+{
+    operator delete(pointer);
+}
+
+void operator delete(void *pointer, size_t, std::align_val_t alignment) noexcept
+{
+    operator delete(pointer, alignment);
+}
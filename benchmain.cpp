@@ -0,0 +1,127 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "benchmark.h"
+
+static void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --size <MiB>         corpus size, 4 by default\n"
+              << "  --repeat <count>     runs per stage, the fastest is reported\n"
+              << "  --stages <list>      comma separated stages, all by default\n"
+              << "  --corpus <list>      comma separated corpora, all by default\n"
+              << "  --format <csv|json>  csv by default\n"
+              << "  --output <file>      standard output by default\n"
+              << "  --verify             check round trips and kernels instead of timing\n\n"
+              << "Stages: " << Pipeline::stageNames() << "\n"
+              << "Corpora: random, text, zeros, bwt, video\n";
+}
+
+static std::vector<std::string> splitList(const std::string &list)
+{
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+
+    while (std::getline(stream, item, ',')) {
+        items.push_back(item);
+    }
+
+    return items;
+}
+
+int main(int argc, char *argv[])
+{
+    BenchmarkOptions options;
+    std::string format = "csv";
+    std::string outputFileName;
+    bool verify = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+
+        if (option == "--verify") {
+            verify = true;
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        std::string value = argv[++i];
+
+        try {
+            if (option == "--size") {
+                options.corpusSize = std::stoul(value) * 1024 * 1024;
+            } else if (option == "--repeat") {
+                options.repeat = std::stoul(value);
+            } else if (option == "--stages") {
+                for (const std::string &name : splitList(value)) {
+                    Pipeline::StageSpec stage;
+
+                    if (!Pipeline::stageFromName(name, stage)) {
+                        std::cerr << "Unknown stage: " << name << "\n";
+                        return 1;
+                    }
+
+                    options.stages.push_back(stage);
+                }
+            } else if (option == "--corpus") {
+                options.corpora = splitList(value);
+            } else if (option == "--format" && (value == "csv" || value == "json")) {
+                format = value;
+            } else if (option == "--output") {
+                outputFileName = value;
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } catch (const std::exception &e) {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (verify) {
+        try {
+            return (Benchmark(options).verify(std::cout) == 0) ? 0 : 1;
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<BenchmarkResult> results;
+
+    try {
+        results = Benchmark(options).run();
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    std::ofstream outputFile;
+
+    if (!outputFileName.empty()) {
+        outputFile.open(outputFileName);
+
+        if (!outputFile) {
+            std::cerr << "Cannot write " << outputFileName << "\n";
+            return 1;
+        }
+    }
+
+    std::ostream &output = outputFileName.empty() ? std::cout : outputFile;
+
+    if (format == "json") {
+        Benchmark::writeJSON(output, results);
+    } else {
+        Benchmark::writeCSV(output, results);
+    }
+
+    return 0;
+}
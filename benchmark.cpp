@@ -0,0 +1,1104 @@
+/******************************************************************************
+ * File Name    : benchmark.cpp
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Throughput And Ratio Benchmark Of Every Pipeline Stage
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#include "benchmark.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+static const uint32_t CorpusSeed = 20240101;
+static const size_t VideoWidth = 256;
+static const size_t VideoHeight = 144;
+
+// Sizes around block, cube, byte and 16 bit boundaries
+static const size_t VerifySizes[] = { 0, 1, 63, 64, 255, 256, 65537 };
+static const size_t CorruptInputSize = 4096;
+static const unsigned CorruptInputRuns = 200;
+static const size_t MaxVerifyChunkSize = 70000;
+// Cuts tried from the start of an encoded stream, and spread over the rest
+static const size_t TruncationHeadCuts = 64;
+static const size_t TruncationSpreadCuts = 32;
+static const size_t AnyCut = SIZE_MAX;
+// Small enough that the corpus spans several blocks of the threaded coder
+static const uint64_t VerifyLZMA2BlockSize = 64 * 1024;
+
+// Decoders must throw on an encoded stream cut to fewer bytes than this.
+// Formats storing their length reject any cut, BWT and sdelta only know
+// their header size.
+struct TruncationRule {
+    Pipeline::Stage stage;
+    size_t rejectedCuts;
+};
+
+static const TruncationRule TruncationRules[] = {
+    { Pipeline::StageBWT, 5 },
+    { Pipeline::StageBlockedBWT, AnyCut },
+    { Pipeline::StageStrideDelta, 9 },
+    { Pipeline::StageLZMA2, AnyCut },
+    { Pipeline::StageLZSS, AnyCut },
+    { Pipeline::StageLZ78, AnyCut },
+    { Pipeline::StageLZW, AnyCut },
+    { Pipeline::StageRANS, AnyCut },
+    { Pipeline::StageCM, AnyCut }
+};
+
+static const char *const TextWords[] = {
+    "the", "of", "and", "to", "a", "in", "is", "that", "for", "it", "as", "was", "with", "be", "by", "on",
+    "not", "he", "this", "are", "or", "his", "from", "at", "which", "but", "have", "an", "had", "they",
+    "you", "were", "their", "one", "all", "we", "can", "her", "has", "there", "been", "if", "more", "when",
+    "will", "would", "who", "so", "no", "data", "block", "stream", "file", "byte", "value", "order", "time",
+    "system", "number", "model", "result", "between", "because", "through", "compression", "entropy",
+    "transform", "sequence", "frequency", "symbol", "context", "window", "pattern", "structure", "memory"
+};
+
+static std::vector<uint8_t> makeRandomCorpus(size_t size)
+{
+    std::mt19937 generator(CorpusSeed);
+    std::vector<uint8_t> corpus(size);
+
+    for (uint8_t &byte : corpus) {
+        byte = static_cast<uint8_t>(generator());
+    }
+
+    return corpus;
+}
+
+// Words follow a Zipf like distribution and lines wrap near 72 columns
+static std::vector<uint8_t> makeTextCorpus(size_t size)
+{
+    const size_t wordCount = sizeof(TextWords) / sizeof(TextWords[0]);
+    std::vector<double> weights(wordCount);
+
+    for (size_t i = 0; i < wordCount; ++i) {
+        weights[i] = 1.0 / (i + 1);
+    }
+
+    std::mt19937 generator(CorpusSeed);
+    std::discrete_distribution<size_t> word(weights.begin(), weights.end());
+    std::uniform_int_distribution<int> sentence(0, 11);
+    std::vector<uint8_t> corpus;
+    corpus.reserve(size + 32);
+    size_t column = 0;
+    bool capital = true;
+
+    while (corpus.size() < size) {
+        std::string next = TextWords[word(generator)];
+
+        if (capital) {
+            next[0] = static_cast<char>(next[0] - 'a' + 'A');
+            capital = false;
+        }
+
+        int end = sentence(generator);
+
+        if (end == 0) {
+            next += '.';
+            capital = true;
+        } else if (end == 1) {
+            next += ',';
+        }
+
+        if (column + next.size() > 72) {
+            corpus.push_back('\n');
+            column = 0;
+        } else if (column != 0) {
+            corpus.push_back(' ');
+            column++;
+        }
+
+        corpus.insert(corpus.end(), next.begin(), next.end());
+        column += next.size();
+    }
+
+    corpus.resize(size);
+    return corpus;
+}
+
+// Grayscale frames of a drifting gradient with a moving square and sensor
+// noise, which gives the inter-frame redundancy of camera footage
+static std::vector<uint8_t> makeVideoCorpus(size_t size)
+{
+    std::mt19937 generator(CorpusSeed);
+    std::uniform_int_distribution<int> noise(-2, 2);
+    std::vector<uint8_t> corpus(size);
+
+    for (size_t pos = 0, frame = 0; pos < size; ++frame) {
+        size_t squareX = (frame * 3) % (VideoWidth - 32);
+        size_t squareY = (frame * 2) % (VideoHeight - 32);
+
+        for (size_t y = 0; y < VideoHeight && pos < size; ++y) {
+            for (size_t x = 0; x < VideoWidth && pos < size; ++x, ++pos) {
+                int value = static_cast<int>((x + frame) / 2 + y / 2) % 256;
+
+                if (x >= squareX && x < squareX + 32 && y >= squareY && y < squareY + 32) {
+                    value = 230;
+                }
+
+                corpus[pos] = static_cast<uint8_t>(std::min(255, std::max(0, value + noise(generator))));
+            }
+        }
+    }
+
+    return corpus;
+}
+
+static std::vector<uint8_t> referenceStrideDelta(std::vector<uint8_t> data, size_t stride, unsigned order)
+{
+    for (unsigned k = 0; k < order; ++k) {
+        for (size_t i = data.size(); i-- > stride;) {
+            data[i] = static_cast<uint8_t>(data[i] - data[i - stride]);
+        }
+    }
+
+    return data;
+}
+
+static std::vector<uint8_t> referenceMTF(const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> list(256);
+    std::vector<uint8_t> encoded;
+
+    for (size_t i = 0; i < 256; ++i) {
+        list[i] = static_cast<uint8_t>(i);
+    }
+
+    for (uint8_t byte : data) {
+        auto position = std::find(list.begin(), list.end(), byte);
+        encoded.push_back(static_cast<uint8_t>(position - list.begin()));
+        list.erase(position);
+        list.insert(list.begin(), byte);
+    }
+
+    return encoded;
+}
+
+// Runs of four to 259 equal bytes become four bytes and the extra count
+static std::vector<uint8_t> referenceThresholdRLE(const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> encoded;
+
+    for (size_t i = 0; i < data.size();) {
+        size_t run = 1;
+
+        while (i + run < data.size() && data[i + run] == data[i] && run < 259) {
+            ++run;
+        }
+
+        if (run >= 4) {
+            encoded.insert(encoded.end(), 4, data[i]);
+            encoded.push_back(static_cast<uint8_t>(run - 4));
+        } else {
+            encoded.insert(encoded.end(), run, data[i]);
+        }
+
+        i += run;
+    }
+
+    return encoded;
+}
+
+static int compareRotations(const std::vector<uint8_t> &data, size_t a, size_t b)
+{
+    for (size_t i = 0; i < data.size(); ++i) {
+        uint8_t x = data[(a + i) % data.size()];
+        uint8_t y = data[(b + i) % data.size()];
+
+        if (x != y) {
+            return (x < y) ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
+
+// Start positions of the rotations in sorted order, by sorting the
+// rotations themselves
+static std::vector<size_t> referenceRotationOrder(const std::vector<uint8_t> &data)
+{
+    std::vector<size_t> order(data.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&data](size_t a, size_t b) {
+        return compareRotations(data, a, b) < 0;
+    });
+    return order;
+}
+
+static void appendUint32(std::vector<uint8_t> &output, size_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8) {
+        output.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+static size_t readUint32(const std::vector<uint8_t> &input, size_t offset)
+{
+    size_t value = 0;
+
+    for (int shift = 0; shift < 32; shift += 8) {
+        value |= static_cast<size_t>(input[offset++]) << shift;
+    }
+
+    return value;
+}
+
+// The first cuts one by one and then cuts spread up to the full size
+static std::vector<size_t> truncationCuts(size_t size)
+{
+    std::vector<size_t> cuts;
+
+    for (size_t cut = 1; cut < size && cut <= TruncationHeadCuts; ++cut) {
+        cuts.push_back(cut);
+    }
+
+    for (size_t i = 1; i <= TruncationSpreadCuts; ++i) {
+        size_t cut = size - 1 - (size - 1) * (i - 1) / TruncationSpreadCuts;
+
+        if (cut > TruncationHeadCuts && cut < size) {
+            cuts.push_back(cut);
+        }
+    }
+
+    return cuts;
+}
+
+double BenchmarkResult::ratio() const
+{
+    return (inputSize == 0) ? 0.0 : static_cast<double>(outputSize) / inputSize;
+}
+
+double BenchmarkResult::encodeMBPerSecond() const
+{
+    return (encodeSeconds <= 0) ? 0.0 : inputSize / encodeSeconds / 1e6;
+}
+
+double BenchmarkResult::decodeMBPerSecond() const
+{
+    return (decodeSeconds <= 0) ? 0.0 : inputSize / decodeSeconds / 1e6;
+}
+
+double BenchmarkResult::encodeNsPerByte() const
+{
+    return (inputSize == 0) ? 0.0 : encodeSeconds * 1e9 / inputSize;
+}
+
+double BenchmarkResult::decodeNsPerByte() const
+{
+    return (inputSize == 0) ? 0.0 : decodeSeconds * 1e9 / inputSize;
+}
+
+Benchmark::Benchmark(const BenchmarkOptions &options) : m_options(options)
+{
+    if (m_options.stages.empty()) {
+        m_options.stages = allStages();
+    }
+
+    if (m_options.corpora.empty()) {
+        m_options.corpora = corpusNames();
+    }
+
+    m_options.repeat = std::max(1u, m_options.repeat);
+}
+
+std::vector<std::string> Benchmark::corpusNames()
+{
+    return { "random", "text", "zeros", "bwt", "video" };
+}
+
+std::vector<uint8_t> Benchmark::makeCorpus(const std::string &name, size_t size)
+{
+    if (name == "random") {
+        return makeRandomCorpus(size);
+    }
+
+    if (name == "text") {
+        return makeTextCorpus(size);
+    }
+
+    if (name == "zeros") {
+        return std::vector<uint8_t>(size, 0);
+    }
+
+    if (name == "bwt") {
+        // The BWT output is four bytes longer than its input
+        std::vector<uint8_t> corpus = makeTextCorpus(std::max<size_t>(size, 4) - 4);
+        encodeWithBWT(corpus);
+        return corpus;
+    }
+
+    if (name == "video") {
+        return makeVideoCorpus(size);
+    }
+
+    throw std::runtime_error("Unknown corpus: " + name);
+}
+
+std::vector<BenchmarkResult> Benchmark::run() const
+{
+    std::vector<BenchmarkResult> results;
+
+    for (const std::string &corpusName : m_options.corpora) {
+        std::vector<uint8_t> corpus = makeCorpus(corpusName, m_options.corpusSize);
+
+        for (const StageSpec &stage : m_options.stages) {
+            std::cerr << stageName(stage) << " on " << corpusName << "..." << std::endl;
+            results.push_back(measure(stage, corpusName, corpus));
+        }
+    }
+
+    return results;
+}
+
+size_t Benchmark::verify(std::ostream &log) const
+{
+    size_t failures = 0;
+    size_t checks = 0;
+
+    for (const std::string &corpusName : m_options.corpora) {
+        std::vector<size_t> sizes(std::begin(VerifySizes), std::end(VerifySizes));
+        sizes.push_back(m_options.corpusSize);
+
+        for (size_t size : sizes) {
+            std::vector<uint8_t> corpus = makeCorpus(corpusName, size);
+            std::cerr << "verifying " << corpusName << " of " << size << " bytes..." << std::endl;
+
+            for (const StageSpec &stage : m_options.stages) {
+                failures += !verifyRoundTrip(stage, corpusName, corpus, log);
+                failures += !verifyChunked(stage, corpusName, corpus, log);
+                checks += 2;
+            }
+
+            failures += verifyReferenceKernels(corpusName, corpus, log);
+            failures += verifyParameters(corpusName, corpus, log);
+            checks += 2;
+
+            if (size == 0 || size == m_options.corpusSize) {
+                failures += verifyFiles(corpusName, corpus, log);
+                checks++;
+            }
+        }
+    }
+
+    std::cerr << "comparing the BWT with sorted rotations..." << std::endl;
+    failures += verifyReferenceBWT(log);
+    checks++;
+
+    // A decoder which crashes on corrupted input ends the run here
+    std::vector<uint8_t> sample = makeCorpus("text", CorruptInputSize);
+
+    for (const StageSpec &stage : m_options.stages) {
+        std::cerr << "corrupting " << stageName(stage) << "..." << std::endl;
+        failures += !verifyCorruptInput(stage, sample, log);
+        checks++;
+    }
+
+    failures += !verifyTruncatedPipeline(sample, log);
+    checks++;
+
+    log << checks << " checks, " << failures << " failures\n";
+    return failures;
+}
+
+bool Benchmark::verifyRoundTrip(const StageSpec &stage, const std::string &corpusName, const std::vector<uint8_t> &data,
+                                std::ostream &log) const
+{
+    try {
+        std::vector<uint8_t> encoded(data);
+        encodeStage(stage, encoded);
+        std::vector<uint8_t> decoded(encoded);
+        decodeStage(stage, decoded);
+
+        if (decoded == data) {
+            return true;
+        }
+
+        log << "FAIL " << stageName(stage) << " round trip on " << corpusName << " of " << data.size()
+            << " bytes: decoded data differs\n";
+    } catch (const std::exception &e) {
+        log << "FAIL " << stageName(stage) << " round trip on " << corpusName << " of " << data.size()
+            << " bytes: " << e.what() << "\n";
+    }
+
+    return false;
+}
+
+// Streams the data through the chunk kernels in chunks of random sizes and
+// compares with the whole buffer kernels
+bool Benchmark::verifyChunked(const StageSpec &stage, const std::string &corpusName, const std::vector<uint8_t> &data,
+                              std::ostream &log) const
+{
+    std::mt19937 generator(CorpusSeed + static_cast<uint32_t>(data.size()));
+
+    auto stream = [&generator](const ChunkKernel &kernel, const std::vector<uint8_t> &input) {
+        std::vector<uint8_t> output;
+        size_t pos = 0;
+
+        runChunkKernels({ kernel }, [&](std::vector<uint8_t> &chunk) {
+            if (pos == input.size()) {
+                return false;
+            }
+
+            size_t size = std::min<size_t>(generator() % MaxVerifyChunkSize + 1, input.size() - pos);
+            chunk.assign(input.begin() + pos, input.begin() + pos + size);
+            pos += size;
+            return true;
+        }, [&output](const std::vector<uint8_t> &chunk) {
+            output.insert(output.end(), chunk.begin(), chunk.end());
+        });
+
+        return output;
+    };
+
+    try {
+        std::vector<uint8_t> expected(data);
+        encodeStage(stage, expected);
+
+        if (stream(encodeKernel(stage), data) != expected) {
+            log << "FAIL " << stageName(stage) << " chunked encoding on " << corpusName << " of " << data.size()
+                << " bytes differs from the whole buffer\n";
+            return false;
+        }
+
+        if (stream(decodeKernel(stage), expected) != data) {
+            log << "FAIL " << stageName(stage) << " chunked decoding on " << corpusName << " of " << data.size()
+                << " bytes differs from the input\n";
+            return false;
+        }
+    } catch (const std::exception &e) {
+        log << "FAIL " << stageName(stage) << " chunked coding on " << corpusName << " of " << data.size()
+            << " bytes: " << e.what() << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+// Truncates, flips bits in and overwrites the header of encoded data. The
+// decoder may throw or return anything, but it must not crash. Cuts the
+// truncation rules cover must throw.
+bool Benchmark::verifyCorruptInput(const StageSpec &stage, const std::vector<uint8_t> &data, std::ostream &log) const
+{
+    std::mt19937 generator(CorpusSeed);
+    std::vector<uint8_t> encoded(data);
+    encodeStage(stage, encoded);
+
+    for (unsigned i = 0; i < CorruptInputRuns && !encoded.empty(); ++i) {
+        std::vector<uint8_t> corrupted(encoded);
+
+        switch (i % 3) {
+        case 0:
+            corrupted.resize(generator() % corrupted.size());
+            break;
+        case 1:
+            for (unsigned k = 0; k <= generator() % 4; ++k) {
+                corrupted[generator() % corrupted.size()] ^= static_cast<uint8_t>(1 << (generator() % 8));
+            }
+
+            break;
+        default:
+            corrupted[generator() % std::min<size_t>(corrupted.size(), 16)] = static_cast<uint8_t>(generator());
+            break;
+        }
+
+        try {
+            decodeStage(stage, corrupted);
+        } catch (const std::exception &e) {
+        }
+    }
+
+    size_t rejectedCuts = 0;
+
+    for (const TruncationRule &rule : TruncationRules) {
+        if (rule.stage == stage.stage) {
+            rejectedCuts = rule.rejectedCuts;
+        }
+    }
+
+    // A cut down to the encoding of empty data is a valid stream
+    std::vector<uint8_t> empty;
+    encodeStage(stage, empty);
+
+    for (size_t cut : truncationCuts(std::min(encoded.size(), rejectedCuts))) {
+        if (cut == empty.size()) {
+            continue;
+        }
+
+        std::vector<uint8_t> truncated(encoded.begin(), encoded.begin() + cut);
+
+        try {
+            decodeStage(stage, truncated);
+        } catch (const std::exception &e) {
+            continue;
+        }
+
+        log << "FAIL " << stageName(stage) << " decoding accepts " << cut << " of " << encoded.size()
+            << " encoded bytes\n";
+        return false;
+    }
+
+    return true;
+}
+
+// The pipeline header stores the stage list and its parameters, a cut
+// inside it must throw, and rANS as the last stage rejects a cut payload
+bool Benchmark::verifyTruncatedPipeline(const std::vector<uint8_t> &data, std::ostream &log) const
+{
+    Pipeline pipeline;
+    pipeline.setStages("sdelta:4:2,rans");
+    std::vector<uint8_t> encoded = pipeline.encode(data);
+
+    for (size_t cut : truncationCuts(encoded.size())) {
+        try {
+            decode(ByteView(encoded.data(), cut));
+        } catch (const std::exception &e) {
+            continue;
+        }
+
+        log << "FAIL pipeline decoding accepts " << cut << " of " << encoded.size() << " encoded bytes\n";
+        return false;
+    }
+
+    return true;
+}
+
+// Compares the suffix array BWT and its interleaved inverse with sorted
+// rotations, on random data and on periodic data whose equal rotations may
+// come in any order. Blocked BWT runs the same data as one block of four
+// streams.
+size_t Benchmark::verifyReferenceBWT(std::ostream &log) const
+{
+    std::mt19937 generator(CorpusSeed);
+    std::vector<std::pair<std::string, std::vector<uint8_t>>> inputs;
+
+    for (size_t size : { 1, 2, 3, 17, 64, 255, 1000 }) {
+        std::vector<uint8_t> random(size);
+
+        for (uint8_t &byte : random) {
+            byte = static_cast<uint8_t>(generator() % 4);
+        }
+
+        inputs.emplace_back("random", random);
+    }
+
+    for (size_t period : { 1, 2, 3, 7 }) {
+        for (size_t size : { 64, 300, 1001 }) {
+            std::vector<uint8_t> periodic(size);
+
+            for (size_t i = 0; i < size; ++i) {
+                periodic[i] = static_cast<uint8_t>('a' + i % period);
+            }
+
+            inputs.emplace_back("period " + std::to_string(period), periodic);
+        }
+    }
+
+    size_t failures = 0;
+
+    auto fail = [&](const std::string &kernel, const std::string &name, size_t size, const std::string &what) {
+        log << "FAIL " << kernel << " on " << name << " of " << size << " bytes " << what << "\n";
+        failures++;
+    };
+
+    for (const auto &input : inputs) {
+        const std::vector<uint8_t> &data = input.second;
+        size_t size = data.size();
+        std::vector<size_t> order = referenceRotationOrder(data);
+        std::vector<size_t> rows(size);
+        std::vector<uint8_t> lastColumn(size);
+
+        for (size_t row = 0; row < size; ++row) {
+            rows[order[row]] = row;
+            lastColumn[row] = data[(order[row] + size - 1) % size];
+        }
+
+        // Any row holding a rotation equal to the one at start is right
+        auto holds = [&](size_t row, size_t start) {
+            return row < size && compareRotations(data, order[row], start) == 0;
+        };
+
+        std::vector<uint8_t> encoded(data);
+        encodeWithBWT(encoded);
+
+        if (encoded.size() != size + 4 || !std::equal(lastColumn.begin(), lastColumn.end(), encoded.begin() + 4) ||
+            !holds(readUint32(encoded, 0), 0)) {
+            fail("bwt", input.first, size, "differs from the sorted rotations");
+        }
+
+        std::vector<uint8_t> decoded;
+        appendUint32(decoded, rows[0]);
+        decoded.insert(decoded.end(), lastColumn.begin(), lastColumn.end());
+        decodeWithBWT(decoded);
+
+        if (decoded != data) {
+            fail("inverse bwt", input.first, size, "does not restore the sorted rotations");
+        }
+
+        // One block of four streams, stream s starts at size * s / 4
+        encoded = data;
+        encodeWithBlockedBWT(encoded, size);
+        const size_t headerSize = 4 + 4 + 4 * 4;
+        bool same = encoded.size() == headerSize + size && readUint32(encoded, 4) == size &&
+                    std::equal(lastColumn.begin(), lastColumn.end(), encoded.begin() + headerSize);
+
+        for (size_t stream = 0; same && stream < 4; ++stream) {
+            same = holds(readUint32(encoded, 8 + stream * 4), size * stream / 4);
+        }
+
+        if (!same) {
+            fail("bbwt", input.first, size, "differs from the sorted rotations");
+            continue;
+        }
+
+        decoded.assign(encoded.begin(), encoded.begin() + 8);
+
+        for (size_t stream = 0; stream < 4; ++stream) {
+            appendUint32(decoded, rows[size * stream / 4]);
+        }
+
+        decoded.insert(decoded.end(), lastColumn.begin(), lastColumn.end());
+        decodeWithBlockedBWT(decoded);
+
+        if (decoded != data) {
+            fail("inverse bbwt", input.first, size, "does not restore the sorted rotations");
+        }
+    }
+
+    return failures;
+}
+
+size_t Benchmark::verifyReferenceKernels(const std::string &corpusName, const std::vector<uint8_t> &data,
+        std::ostream &log) const
+{
+    size_t failures = 0;
+
+    auto check = [&](const std::string &kernel, const std::vector<uint8_t> &output,
+    const std::vector<uint8_t> &expected) {
+        if (output != expected) {
+            log << "FAIL " << kernel << " on " << corpusName << " of " << data.size()
+                << " bytes differs from the reference\n";
+            failures++;
+        }
+    };
+
+    std::vector<uint8_t> output(data);
+    encodeWithDelta(output);
+    check("delta", output, referenceStrideDelta(data, 1, 1));
+
+    for (uint32_t stride : { 1, 2, 3, 4, 8, 16, 17 }) {
+        for (uint32_t order : { 1, 2 }) {
+            output = encodeViewWithStrideDelta(data, stride, order);
+            output.erase(output.begin(), output.begin() + std::min<size_t>(output.size(), 9));
+            check("sdelta stride " + std::to_string(stride) + " order " + std::to_string(order), output,
+                  referenceStrideDelta(data, stride, order));
+        }
+    }
+
+    output = data;
+    encodeWithMTF(output);
+    check("mtf", output, referenceMTF(data));
+
+    output = encodeViewWithThresholdRLE(data);
+    check("trle", output, referenceThresholdRLE(data));
+
+    return failures;
+}
+
+// Round trips the coders with options other than the defaults and sdelta
+// with other strides and orders
+size_t Benchmark::verifyParameters(const std::string &corpusName, const std::vector<uint8_t> &data,
+                                   std::ostream &log) const
+{
+    typedef std::function<std::vector<uint8_t>(const ByteView &)> Coder;
+    size_t failures = 0;
+
+    auto check = [&](const std::string &name, const Coder &compress, const Coder &decompress) {
+        try {
+            if (decompress(compress(data)) == data) {
+                return;
+            }
+
+            log << "FAIL " << name << " round trip on " << corpusName << " of " << data.size()
+                << " bytes: decoded data differs\n";
+        } catch (const std::exception &e) {
+            log << "FAIL " << name << " round trip on " << corpusName << " of " << data.size()
+                << " bytes: " << e.what() << "\n";
+        }
+
+        failures++;
+    };
+
+    LZ77Options lazyLZ77;
+    lazyLZ77.parsing = LZ77Options::ParsingLazy;
+    lazyLZ77.searchDepth = 16;
+    LZ77Options optimalLZ77;
+    optimalLZ77.parsing = LZ77Options::ParsingOptimal;
+    optimalLZ77.searchDepth = 16;
+
+    for (const LZ77Options &options : { lazyLZ77, optimalLZ77 }) {
+        check(std::string("lz77 ") + (options.parsing == LZ77Options::ParsingLazy ? "lazy" : "optimal"),
+        [&options](const ByteView &input) {
+            return compressWithLZ77(input, options);
+        }, &decompressWithLZ77);
+    }
+
+    for (uint32_t windowBits : { 10, 16, 24 }) {
+        for (bool lazy : { false, true }) {
+            LZSSOptions options;
+            options.windowBits = windowBits;
+            options.lazy = lazy;
+            check("lzss window " + std::to_string(windowBits) + (lazy ? " lazy" : " greedy"),
+            [&options](const ByteView &input) {
+                return compressWithLZSS(input, options);
+            }, &decompressWithLZSS);
+        }
+    }
+
+    // Nine bit codes fill the dictionary early, so the resets are exercised
+    for (uint32_t maxBits : { 9, 12, 20 }) {
+        for (bool adaptiveReset : { false, true }) {
+            LZWOptions options;
+            options.maxBits = maxBits;
+            options.adaptiveReset = adaptiveReset;
+            std::string suffix = " bits " + std::to_string(maxBits) + (adaptiveReset ? " reset" : " frozen");
+
+            check("lzw" + suffix, [&options](const ByteView &input) {
+                return compressWithLZW(input, options);
+            }, &decompressWithLZW);
+            check("lz78" + suffix, [&options](const ByteView &input) {
+                return compressWithLZ78(input, options);
+            }, &decompressWithLZ78);
+        }
+    }
+
+    LZMA2Options threaded;
+    threaded.threadCount = 2;
+    threaded.blockSize = VerifyLZMA2BlockSize;
+
+    check("lzma2 threads 2", [&threaded](const ByteView &input) {
+        return compressWithLZMA2(input, threaded);
+    }, [&threaded](const ByteView &input) {
+        return decompressWithLZMA2(input, threaded);
+    });
+    check("lzma2 threaded encoder single decoder", [&threaded](const ByteView &input) {
+        return compressWithLZMA2(input, threaded);
+    }, [](const ByteView &input) {
+        return decompressWithLZMA2(input);
+    });
+
+    for (uint32_t stride : { 1, 2, 3, 4, 17 }) {
+        for (uint32_t order : { 1, 2, 3 }) {
+            StageSpec stage(StageStrideDelta, stride, order);
+            failures += !verifyRoundTrip(stage, corpusName, data, log);
+            failures += !verifyChunked(stage, corpusName, data, log);
+        }
+    }
+
+    return failures;
+}
+
+static bool writeWholeFile(const std::string &fileName, const std::vector<uint8_t> &data)
+{
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(file);
+}
+
+static bool readWholeFile(const std::string &fileName, std::vector<uint8_t> &data)
+{
+    std::ifstream file(fileName, std::ios::binary);
+
+    if (!file) {
+        return false;
+    }
+
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// Round trips the data through every file function, these take the mapped,
+// chunked and pipelined paths the in memory checks do not reach
+size_t Benchmark::verifyFiles(const std::string &corpusName, const std::vector<uint8_t> &data,
+                              std::ostream &log) const
+{
+    typedef std::function<bool(const std::string &, const std::string &)> FileCoder;
+
+    struct FileCheck {
+        std::string name;
+        FileCoder encode;
+        FileCoder decode;
+    };
+
+    Pipeline coder;
+    LZMA2Options threaded;
+    threaded.threadCount = 2;
+    threaded.blockSize = VerifyLZMA2BlockSize;
+
+    auto member = [&coder](bool (Pipeline::*function)(const std::string &, const std::string &)) {
+        return [&coder, function](const std::string &input, const std::string &output) {
+            return (coder.*function)(input, output);
+        };
+    };
+
+    std::vector<FileCheck> fileChecks = {
+        { "bwt", member(&Pipeline::encodeFileWithBWT), member(&Pipeline::decodeFileWithBWT) },
+        { "bbwt", [&coder](const std::string &input, const std::string &output) {
+            return coder.encodeFileWithBlockedBWT(input, output);
+        }, [&coder](const std::string &input, const std::string &output) {
+            return coder.decodeFileWithBlockedBWT(input, output);
+        } },
+        { "delta", member(&Pipeline::encodeFileWithDelta), member(&Pipeline::decodeFileWithDelta) },
+        { "sdelta:4:2", [&coder](const std::string &input, const std::string &output) {
+            return coder.encodeFileWithStrideDelta(input, output, 4, 2);
+        }, member(&Pipeline::decodeFileWithStrideDelta) },
+        { "cube", member(&Pipeline::encodeFileWithCube), member(&Pipeline::decodeFileWithCube) },
+        { "complement", member(&Pipeline::encodeFileWithComplement), member(&Pipeline::decodeFileWithComplement) },
+        { "blocksort", member(&Pipeline::encodeFileWithBlockSort), member(&Pipeline::decodeFileWithBlockSort) },
+        { "pb", member(&Pipeline::encodeFileWithPB), member(&Pipeline::decodeFileWithPB) },
+        { "mtf", member(&Pipeline::encodeFileWithMTF), member(&Pipeline::decodeFileWithMTF) },
+        { "rle", member(&Pipeline::encodeFileWithRLE), member(&Pipeline::decodeFileWithRLE) },
+        { "trle", member(&Pipeline::encodeFileWithThresholdRLE), member(&Pipeline::decodeFileWithThresholdRLE) },
+        { "lzma2", [&coder](const std::string &input, const std::string &output) {
+            return coder.compressFileWithLZMA2(input, output);
+        }, [&coder](const std::string &input, const std::string &output) {
+            return coder.decompressFileWithLZMA2(input, output);
+        } },
+        { "lzma2 threads 2", [&coder, &threaded](const std::string &input, const std::string &output) {
+            return coder.compressFileWithLZMA2(input, output, threaded);
+        }, [&coder, &threaded](const std::string &input, const std::string &output) {
+            return coder.decompressFileWithLZMA2(input, output, threaded);
+        } },
+        { "lz77", [&coder](const std::string &input, const std::string &output) {
+            return coder.compressFileWithLZ77(input, output);
+        }, member(&Pipeline::decompressFileWithLZ77) },
+        { "lzss", [&coder](const std::string &input, const std::string &output) {
+            return coder.compressFileWithLZSS(input, output);
+        }, member(&Pipeline::decompressFileWithLZSS) },
+        { "lz78", [&coder](const std::string &input, const std::string &output) {
+            return coder.compressFileWithLZ78(input, output);
+        }, member(&Pipeline::decompressFileWithLZ78) },
+        { "lzw", [&coder](const std::string &input, const std::string &output) {
+            return coder.compressFileWithLZW(input, output);
+        }, member(&Pipeline::decompressFileWithLZW) },
+        { "rans", [&coder](const std::string &input, const std::string &output) {
+            return coder.compressFileWithRANS(input, output);
+        }, member(&Pipeline::decompressFileWithRANS) },
+        { "cm", member(&Pipeline::compressFileWithCM), member(&Pipeline::decompressFileWithCM) }
+    };
+
+    // The streamed pipeline must also write what encode gives in memory
+    for (const char *stageList : { "bwt,mtf,rle,lzma2", "sdelta:4:2,cube,blocksort,rans" }) {
+        auto pipeline = std::make_shared<Pipeline>();
+        pipeline->setStages(stageList);
+
+        fileChecks.push_back({ std::string("pipeline ") + stageList,
+        [pipeline, &data](const std::string &input, const std::string &output) {
+            std::vector<uint8_t> encoded;
+            return pipeline->encodeFileWithPipeline(input, output) && readWholeFile(output, encoded) &&
+                   encoded == pipeline->encode(data);
+        }, [](const std::string &input, const std::string &output) {
+            return decodeFileWithPipeline(input, output);
+        } });
+    }
+
+    std::string baseName = (std::filesystem::temp_directory_path() /
+                            ("entropyreducer-verify-" + std::to_string(::getpid()))).string();
+    std::string inputName = baseName + ".in";
+    std::string encodedName = baseName + ".enc";
+    std::string decodedName = baseName + ".out";
+    std::string inPlaceName = baseName + ".inplace";
+    std::string truncatedName = baseName + ".truncated";
+    std::string rejectedName = baseName + ".rejected";
+    size_t failures = 0;
+
+    if (!writeWholeFile(inputName, data)) {
+        log << "FAIL files on " << corpusName << " of " << data.size() << " bytes: " << inputName
+            << " could not be written\n";
+        return 1;
+    }
+
+    // The output may name the input, the file is replaced only at the end
+    auto verifyFileInPlace = [&](const FileCheck &fileCheck, const std::string &name) {
+        std::vector<uint8_t> decoded;
+
+        if (writeWholeFile(name, data) && fileCheck.encode(name, name) && fileCheck.decode(name, name) &&
+            readWholeFile(name, decoded) && decoded == data) {
+            return true;
+        }
+
+        log << "FAIL " << fileCheck.name << " in place file round trip on " << corpusName << " of "
+            << data.size() << " bytes\n";
+        return false;
+    };
+
+    // A decoder which rejects a truncated file must not leave an output
+    auto verifyFileRejected = [&](const FileCheck &fileCheck, const std::string &encodedFile,
+    const std::string &truncatedFile, const std::string &outputFile) {
+        std::vector<uint8_t> encoded;
+        std::remove(outputFile.c_str());
+
+        if (!readWholeFile(encodedFile, encoded) || encoded.empty()) {
+            return true;
+        }
+
+        encoded.resize(encoded.size() / 2);
+
+        if (!writeWholeFile(truncatedFile, encoded) || fileCheck.decode(truncatedFile, outputFile) ||
+            !std::filesystem::exists(outputFile)) {
+            return true;
+        }
+
+        log << "FAIL " << fileCheck.name << " file decoding of a truncated file on " << corpusName << " of "
+            << data.size() << " bytes left an output\n";
+        return false;
+    };
+
+    for (const FileCheck &fileCheck : fileChecks) {
+        std::vector<uint8_t> decoded;
+
+        if (!fileCheck.encode(inputName, encodedName)) {
+            log << "FAIL " << fileCheck.name << " file encoding on " << corpusName << " of " << data.size()
+                << " bytes\n";
+            failures++;
+        } else if (!fileCheck.decode(encodedName, decodedName) || !readWholeFile(decodedName, decoded)) {
+            log << "FAIL " << fileCheck.name << " file decoding on " << corpusName << " of " << data.size()
+                << " bytes\n";
+            failures++;
+        } else if (decoded != data) {
+            log << "FAIL " << fileCheck.name << " file round trip on " << corpusName << " of " << data.size()
+                << " bytes: decoded data differs\n";
+            failures++;
+        } else {
+            failures += !verifyFileInPlace(fileCheck, inPlaceName);
+            failures += !verifyFileRejected(fileCheck, encodedName, truncatedName, rejectedName);
+        }
+    }
+
+    for (const std::string &name : { inputName, encodedName, decodedName, inPlaceName, truncatedName,
+                                     rejectedName }) {
+        std::remove(name.c_str());
+    }
+
+    return failures;
+}
+
+BenchmarkResult Benchmark::measure(const StageSpec &stage, const std::string &corpusName,
+                                   const std::vector<uint8_t> &corpus) const
+{
+    typedef std::chrono::steady_clock Clock;
+
+    BenchmarkResult result;
+    result.stage = stageName(stage);
+    result.corpus = corpusName;
+    result.inputSize = corpus.size();
+    result.encodeSeconds = std::numeric_limits<double>::max();
+    result.decodeSeconds = std::numeric_limits<double>::max();
+
+    resetPeakRSS();
+
+    for (unsigned i = 0; i < m_options.repeat; ++i) {
+        std::vector<uint8_t> data(corpus);
+
+        Clock::time_point start = Clock::now();
+        encodeStage(stage, data);
+        Clock::time_point encoded = Clock::now();
+        result.outputSize = data.size();
+        decodeStage(stage, data);
+        Clock::time_point decoded = Clock::now();
+
+        result.encodeSeconds = std::min(result.encodeSeconds,
+                                        std::chrono::duration<double>(encoded - start).count());
+        result.decodeSeconds = std::min(result.decodeSeconds,
+                                        std::chrono::duration<double>(decoded - encoded).count());
+    }
+
+    result.peakRSS = peakRSS();
+    return result;
+}
+
+// Linux resets the high water mark when 5 is written to clear_refs, other
+// systems report the peak of the whole process. Free heap pages are given
+// back first, or the previous run would still count.
+void Benchmark::resetPeakRSS()
+{
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+
+    std::ofstream clearRefs("/proc/self/clear_refs");
+
+    if (clearRefs) {
+        clearRefs << "5";
+    }
+}
+
+uint64_t Benchmark::peakRSS()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::stoull(line.substr(6)) * 1024;
+        }
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+}
+
+void Benchmark::writeCSV(std::ostream &output, const std::vector<BenchmarkResult> &results)
+{
+    output << "stage,corpus,input_bytes,output_bytes,ratio,encode_mb_s,encode_ns_byte,"
+           << "decode_mb_s,decode_ns_byte,peak_rss_bytes\n";
+
+    for (const BenchmarkResult &result : results) {
+        output << result.stage << ',' << result.corpus << ',' << result.inputSize << ',' << result.outputSize << ','
+               << std::fixed << std::setprecision(4) << result.ratio() << ','
+               << std::setprecision(2) << result.encodeMBPerSecond() << ',' << result.encodeNsPerByte() << ','
+               << result.decodeMBPerSecond() << ',' << result.decodeNsPerByte() << ','
+               << result.peakRSS << '\n';
+    }
+}
+
+void Benchmark::writeJSON(std::ostream &output, const std::vector<BenchmarkResult> &results)
+{
+    output << "[\n";
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult &result = results[i];
+
+        output << "  {\"stage\": \"" << result.stage << "\", \"corpus\": \"" << result.corpus << "\", "
+               << "\"input_bytes\": " << result.inputSize << ", \"output_bytes\": " << result.outputSize << ", "
+               << std::fixed << std::setprecision(4) << "\"ratio\": " << result.ratio() << ", "
+               << std::setprecision(2) << "\"encode_mb_s\": " << result.encodeMBPerSecond() << ", "
+               << "\"encode_ns_byte\": " << result.encodeNsPerByte() << ", "
+               << "\"decode_mb_s\": " << result.decodeMBPerSecond() << ", "
+               << "\"decode_ns_byte\": " << result.decodeNsPerByte() << ", "
+               << "\"peak_rss_bytes\": " << result.peakRSS << "}"
+               << ((i + 1 < results.size()) ? ",\n" : "\n");
+    }
+
+    output << "]\n";
+}
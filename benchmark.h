@@ -0,0 +1,94 @@
+/******************************************************************************
+ * File Name    : benchmark.h
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Throughput And Ratio Benchmark Of Every Pipeline Stage
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+
+#include "pipeline.h"
+
+struct BenchmarkOptions {
+    size_t corpusSize = 4 * 1024 * 1024;
+    // Each stage runs this many times, the fastest run is reported
+    unsigned repeat = 1;
+    // Empty lists select every stage and every corpus
+    std::vector<Pipeline::StageSpec> stages;
+    std::vector<std::string> corpora;
+};
+
+struct BenchmarkResult {
+    std::string stage;
+    std::string corpus;
+    size_t inputSize = 0;
+    size_t outputSize = 0;
+    double encodeSeconds = 0;
+    double decodeSeconds = 0;
+    // Highest resident set size during the run, in bytes
+    uint64_t peakRSS = 0;
+
+    double ratio() const;
+    double encodeMBPerSecond() const;
+    double decodeMBPerSecond() const;
+    double encodeNsPerByte() const;
+    double decodeNsPerByte() const;
+};
+
+class Benchmark : public Pipeline
+{
+public:
+    explicit Benchmark(const BenchmarkOptions &options = BenchmarkOptions());
+
+    // random, text, zeros, bwt and video. Every corpus is generated from a
+    // fixed seed, so runs compare across builds.
+    static std::vector<std::string> corpusNames();
+    static std::vector<uint8_t> makeCorpus(const std::string &name, size_t size);
+
+    std::vector<BenchmarkResult> run() const;
+
+    // Checks the selected stages instead of timing them. Every stage must
+    // round trip at edge sizes and the corpus size, give the same output
+    // when streamed in random chunks, and throw or return on corrupted
+    // input. Formats which store their length must throw on any truncation,
+    // formats with only a header on a cut inside it. The SIMD kernels and
+    // the BWT are compared with plain reference versions, the coder options
+    // and sdelta parameters must round trip, and so must the file functions
+    // at the edge and corpus sizes. Failures are written to log, their count
+    // is returned.
+    size_t verify(std::ostream &log) const;
+
+    static void writeCSV(std::ostream &output, const std::vector<BenchmarkResult> &results);
+    static void writeJSON(std::ostream &output, const std::vector<BenchmarkResult> &results);
+
+private:
+    BenchmarkResult measure(const StageSpec &stage, const std::string &corpusName,
+                            const std::vector<uint8_t> &corpus) const;
+
+    bool verifyRoundTrip(const StageSpec &stage, const std::string &corpusName, const std::vector<uint8_t> &data,
+                         std::ostream &log) const;
+    bool verifyChunked(const StageSpec &stage, const std::string &corpusName, const std::vector<uint8_t> &data,
+                       std::ostream &log) const;
+    bool verifyCorruptInput(const StageSpec &stage, const std::vector<uint8_t> &data, std::ostream &log) const;
+    bool verifyTruncatedPipeline(const std::vector<uint8_t> &data, std::ostream &log) const;
+    size_t verifyReferenceBWT(std::ostream &log) const;
+    size_t verifyReferenceKernels(const std::string &corpusName, const std::vector<uint8_t> &data,
+                                  std::ostream &log) const;
+    size_t verifyParameters(const std::string &corpusName, const std::vector<uint8_t> &data,
+                            std::ostream &log) const;
+    size_t verifyFiles(const std::string &corpusName, const std::vector<uint8_t> &data, std::ostream &log) const;
+
+    static void resetPeakRSS();
+    static uint64_t peakRSS();
+
+    BenchmarkOptions m_options;
+};
+
+#endif // BENCHMARK_H
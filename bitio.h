@@ -0,0 +1,105 @@
+/******************************************************************************
+ * File Name    : bitio.h
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Least Significant Bit First Bit Stream Writer And Reader
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#ifndef BITIO_H
+#define BITIO_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "byteview.h"
+
+class BitWriter
+{
+public:
+    explicit BitWriter(std::vector<uint8_t> &output) : m_output(output), m_buffer(0), m_bitCount(0), m_bitsWritten(0) {}
+
+    // Appends the low bitCount bits of value, at most 32 at once
+    void write(uint32_t value, unsigned bitCount)
+    {
+        m_buffer |= static_cast<uint64_t>(value & ((uint64_t(1) << bitCount) - 1)) << m_bitCount;
+        m_bitCount += bitCount;
+        m_bitsWritten += bitCount;
+
+        if (m_bitCount >= 32) {
+            for (unsigned i = 0; i < 4; ++i) {
+                m_output.push_back(static_cast<uint8_t>(m_buffer >> (i * 8)));
+            }
+
+            m_buffer >>= 32;
+            m_bitCount -= 32;
+        }
+    }
+
+    // Pads the last byte with zero bits
+    void flush()
+    {
+        while (m_bitCount > 0) {
+            m_output.push_back(static_cast<uint8_t>(m_buffer));
+            m_buffer >>= 8;
+            m_bitCount = (m_bitCount > 8) ? m_bitCount - 8 : 0;
+        }
+
+        m_buffer = 0;
+    }
+
+    uint64_t bitsWritten() const
+    {
+        return m_bitsWritten;
+    }
+
+private:
+    std::vector<uint8_t> &m_output;
+    uint64_t m_buffer;
+    unsigned m_bitCount;
+    uint64_t m_bitsWritten;
+};
+
+class BitReader
+{
+public:
+    explicit BitReader(const ByteView &input) : m_data(input.data()), m_size(input.size()), m_pos(0), m_buffer(0),
+        m_bitCount(0) {}
+
+    // Takes the next bitCount bits, at most 32 at once. Throws when the
+    // stream ends first.
+    uint32_t read(unsigned bitCount)
+    {
+        if (m_bitCount < bitCount) {
+            refill();
+
+            if (m_bitCount < bitCount) {
+                throw std::runtime_error("Bit stream is truncated!");
+            }
+        }
+
+        uint32_t value = static_cast<uint32_t>(m_buffer & ((uint64_t(1) << bitCount) - 1));
+        m_buffer >>= bitCount;
+        m_bitCount -= bitCount;
+        return value;
+    }
+
+private:
+    void refill()
+    {
+        while (m_bitCount <= 56 && m_pos < m_size) {
+            m_buffer |= static_cast<uint64_t>(m_data[m_pos++]) << m_bitCount;
+            m_bitCount += 8;
+        }
+    }
+
+    const uint8_t *m_data;
+    size_t m_size;
+    size_t m_pos;
+    uint64_t m_buffer;
+    unsigned m_bitCount;
+};
+
+#endif // BITIO_H
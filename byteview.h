@@ -0,0 +1,63 @@
+/******************************************************************************
+ * File Name    : byteview.h
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Non Owning View Over Contiguous Bytes
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#ifndef BYTEVIEW_H
+#define BYTEVIEW_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class ByteView
+{
+public:
+    ByteView() : m_data(nullptr), m_size(0) {}
+    ByteView(const uint8_t *data, size_t size) : m_data(data), m_size(size) {}
+    ByteView(const std::vector<uint8_t> &data) : m_data(data.data()), m_size(data.size()) {}
+
+    const uint8_t *data() const
+    {
+        return m_data;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    const uint8_t *begin() const
+    {
+        return m_data;
+    }
+
+    const uint8_t *end() const
+    {
+        return m_data + m_size;
+    }
+
+    const uint8_t &operator[](size_t index) const
+    {
+        return m_data[index];
+    }
+
+    ByteView subview(size_t offset, size_t size) const
+    {
+        return ByteView(m_data + offset, size);
+    }
+
+private:
+    const uint8_t *m_data;
+    size_t m_size;
+};
+
+#endif // BYTEVIEW_H
@@ -7,13 +7,17 @@
  ******************************************************************************/
 
 #include "compressionalgorithms.h"
+#include "fileio.h"
+#include "matchfinder.h"
+#include "bitio.h"
+#include "rans.h"
+#include "contextmixing.h"
 
 #include <lzma.h>
+#include <algorithm>
+#include <cstring>
 #include <locale>
 #include <stdexcept>
-#include <fstream>
-#include <stdexcept>
-#include <map>
 #include <vector>
 #include <cstdint>
 #include <iostream>
@@ -24,6 +28,564 @@ struct LZ77Token {
     uint8_t nextChar;
 };
 
+static const size_t LZ77WindowSize = 4096;
+static const size_t LZ77MaxLength = 18;
+static const size_t LZ77LookaheadSize = LZ77MaxLength + 2;
+
+// LZSS, LZW and LZ78 data start with a magic, one parameter byte and the
+// 64-bit little endian size of the raw data
+static const size_t LZHeaderSize = 13;
+
+// Every LZSS flag byte is followed by eight literals or matches
+static const uint8_t LZSSMagic[4] = { 'L', 'Z', 'S', 'S' };
+static const uint32_t LZSSMinWindowBits = 10;
+static const uint32_t LZSSMaxWindowBits = 24;
+static const size_t LZSSMinLength = 3;
+static const size_t LZSSMaxLength = 65536;
+// Matches keep the low bits of their first varint for the length
+static const unsigned LZSSLengthBits = 4;
+static const size_t LZSSLengthMask = (1 << LZSSLengthBits) - 1;
+
+// LZW and LZ78 codes grow from 9 bits, LZW starts its dictionary with the
+// bytes and LZ78 with the empty phrase. A CLEAR code resets it.
+static const uint8_t LZWMagic[4] = { 'L', 'Z', 'W', 'B' };
+static const uint8_t LZ78Magic[4] = { 'L', 'Z', '8', 'B' };
+static const uint32_t LZMinCodeBits = 9;
+static const uint32_t LZMaxCodeBits = 20;
+static const uint32_t LZWClearCode = 256;
+static const uint32_t LZWFirstCode = 257;
+static const uint32_t LZ78ClearCode = 1;
+static const uint32_t LZ78FirstCode = 2;
+// A full dictionary is checked after this many input bytes and reset when
+// its ratio got worse since the last check
+static const size_t LZResetCheckInterval = 64 * 1024;
+
+static const size_t LZMABufferSize = 1024 * 1024;
+
+static const uint8_t RANSMagic[4] = { 'R', 'A', 'N', 'S' };
+
+// Context mixing data has the LZ header, its parameter byte is the highest
+// model order
+static const uint8_t CMMagic[4] = { 'C', 'M', 'I', 'X' };
+static const uint8_t CMMaxOrder = 2;
+
+// Matches are copied in whole words and may write this many bytes past
+// their end, decoders keep it free behind the output
+static const size_t WildCopySlack = 16;
+
+static inline void copyMatch(uint8_t *output, size_t offset, size_t length)
+{
+    const uint8_t *source = output - offset;
+    uint8_t *end = output + length;
+
+    if (offset >= 16) {
+        do {
+            std::memcpy(output, source, 16);
+            output += 16;
+            source += 16;
+        } while (output < end);
+        return;
+    }
+
+    if (offset < 8) {
+        // Repeat the short period up to a word, then keep a distance which
+        // is a multiple of the period and at least a word
+        for (unsigned i = 0; i < 8; ++i) {
+            output[i] = source[i];
+        }
+
+        output += 8;
+        source = output - ((8 + offset - 1) / offset) * offset;
+    }
+
+    while (output < end) {
+        std::memcpy(output, source, 8);
+        output += 8;
+        source += 8;
+    }
+}
+
+// Children of LZ78 and LZW phrases, keyed by their parent code and last
+// byte in a flat open addressing table
+class PhraseTrie
+{
+public:
+    static constexpr uint32_t NoCode = UINT32_MAX;
+
+    explicit PhraseTrie(size_t capacity)
+    {
+        size_t size = 1;
+
+        while (size < capacity * 2) {
+            size <<= 1;
+        }
+
+        m_slots.assign(size, 0);
+        m_mask = size - 1;
+    }
+
+    uint32_t find(uint32_t parent, uint8_t byte) const
+    {
+        uint64_t key = makeKey(parent, byte);
+
+        for (size_t slot = hash(key);; slot = (slot + 1) & m_mask) {
+            uint64_t entry = m_slots[slot];
+
+            if ((entry >> 32) == key) {
+                return static_cast<uint32_t>(entry);
+            }
+
+            if (entry == 0) {
+                return NoCode;
+            }
+        }
+    }
+
+    void insert(uint32_t parent, uint8_t byte, uint32_t code)
+    {
+        uint64_t key = makeKey(parent, byte);
+        size_t slot = hash(key);
+
+        while (m_slots[slot] != 0) {
+            slot = (slot + 1) & m_mask;
+        }
+
+        m_slots[slot] = (key << 32) | code;
+    }
+
+    void clear()
+    {
+        std::fill(m_slots.begin(), m_slots.end(), 0);
+    }
+
+private:
+    // Keys are offset by one, an empty slot is zero
+    static uint64_t makeKey(uint32_t parent, uint8_t byte)
+    {
+        return ((static_cast<uint64_t>(parent) << 8) | byte) + 1;
+    }
+
+    size_t hash(uint64_t key) const
+    {
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & m_mask;
+    }
+
+    std::vector<uint64_t> m_slots;
+    size_t m_mask;
+};
+
+static void putLZHeader(std::vector<uint8_t> &output, const uint8_t *magic, uint8_t parameter, uint64_t size)
+{
+    output.insert(output.end(), magic, magic + 4);
+    output.push_back(parameter);
+
+    for (unsigned i = 0; i < 8; ++i) {
+        output.push_back(static_cast<uint8_t>(size >> (i * 8)));
+    }
+}
+
+static bool getLZHeader(const ByteView &input, const uint8_t *magic, uint8_t &parameter, uint64_t &size)
+{
+    if (input.size() < LZHeaderSize || !std::equal(magic, magic + 4, input.begin())) {
+        return false;
+    }
+
+    parameter = input[4];
+    size = 0;
+
+    for (unsigned i = 0; i < 8; ++i) {
+        size |= static_cast<uint64_t>(input[5 + i]) << (i * 8);
+    }
+
+    return true;
+}
+
+static void checkCodeBits(uint32_t maxBits)
+{
+    if (maxBits < LZMinCodeBits || maxBits > LZMaxCodeBits) {
+        throw std::runtime_error("Invalid code size!");
+    }
+}
+
+// Smallest width which holds every code below codeCount
+static unsigned codeBits(uint32_t codeCount)
+{
+    unsigned bits = LZMinCodeBits;
+
+    while ((uint32_t(1) << bits) < codeCount) {
+        ++bits;
+    }
+
+    return bits;
+}
+
+// A phrase is at most one byte longer than the phrases decoded before it,
+// which bounds the size a corrupted header can claim
+static bool isPlausiblePhraseOutput(uint64_t dataSize, size_t payloadSize)
+{
+    uint64_t codes = static_cast<uint64_t>(payloadSize) * 8 / LZMinCodeBits + 1;
+    return codes > UINT32_MAX || dataSize <= codes * (codes + 1) / 2;
+}
+
+// Decoded LZW and LZ78 phrases are kept as their prefix code and last byte
+struct PhraseEntry {
+    static constexpr uint32_t NoPrefix = UINT32_MAX;
+
+    uint32_t prefix;
+    uint32_t length;
+    uint8_t lastByte;
+};
+
+// Writes the phrase backwards from its last byte, the output must hold its
+// whole length
+static inline void writePhrase(const PhraseEntry *dictionary, uint32_t code, uint8_t *output)
+{
+    uint8_t *p = output + dictionary[code].length;
+
+    while (p != output) {
+        *--p = dictionary[code].lastByte;
+        code = dictionary[code].prefix;
+    }
+}
+
+class DictionaryResetMonitor
+{
+public:
+    DictionaryResetMonitor() : m_nextCheck(0), m_lastInput(0), m_lastBits(0), m_bestRatio(0) {}
+
+    // Called while the dictionary is full, returns true when it should be
+    // cleared before the next phrase
+    bool check(size_t input, uint64_t bits)
+    {
+        if (m_nextCheck == 0) {
+            start(input, bits);
+            return false;
+        }
+
+        if (input < m_nextCheck) {
+            return false;
+        }
+
+        double ratio = static_cast<double>(input - m_lastInput) / static_cast<double>(bits - m_lastBits + 1);
+        m_lastInput = input;
+        m_lastBits = bits;
+        m_nextCheck = input + LZResetCheckInterval;
+
+        if (ratio < m_bestRatio) {
+            m_nextCheck = 0;
+            return true;
+        }
+
+        m_bestRatio = ratio;
+        return false;
+    }
+
+private:
+    void start(size_t input, uint64_t bits)
+    {
+        m_nextCheck = input + LZResetCheckInterval;
+        m_lastInput = input;
+        m_lastBits = bits;
+        m_bestRatio = 0;
+    }
+
+    size_t m_nextCheck;
+    size_t m_lastInput;
+    uint64_t m_lastBits;
+    double m_bestRatio;
+};
+
+static void putVarint(std::vector<uint8_t> &output, uint64_t value)
+{
+    while (value >= 0x80) {
+        output.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+
+    output.push_back(static_cast<uint8_t>(value));
+}
+
+static uint64_t getVarint(const ByteView &input, size_t &pos)
+{
+    uint64_t value = 0;
+
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (pos >= input.size()) {
+            break;
+        }
+
+        uint8_t byte = input[pos++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+
+    throw std::runtime_error("Invalid varint!");
+}
+
+static size_t varintSize(uint64_t value)
+{
+    size_t size = 1;
+
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+
+    return size;
+}
+
+static size_t lzssMatchSize(size_t offset, size_t length)
+{
+    size_t lengthCode = length - LZSSMinLength;
+    size_t size = varintSize(((offset - 1) << LZSSLengthBits) | std::min(lengthCode, LZSSLengthMask));
+
+    if (lengthCode >= LZSSLengthMask) {
+        size += varintSize(lengthCode - LZSSLengthMask);
+    }
+
+    return size;
+}
+
+static lzma_check toLZMACheck(LZMA2Options::Check check)
+{
+    switch (check) {
+    case LZMA2Options::CheckNone:
+        return LZMA_CHECK_NONE;
+    case LZMA2Options::CheckCRC32:
+        return LZMA_CHECK_CRC32;
+    case LZMA2Options::CheckSHA256:
+        return LZMA_CHECK_SHA256;
+    default:
+        return LZMA_CHECK_CRC64;
+    }
+}
+
+static uint32_t lzmaThreadCount(const LZMA2Options &options)
+{
+    if (options.threadCount != 0) {
+        return options.threadCount;
+    }
+
+    return std::max<uint32_t>(1, lzma_cputhreads());
+}
+
+static void initLZMA2Encoder(lzma_stream &strm, const LZMA2Options &options)
+{
+    lzma_options_lzma lzmaOptions;
+    uint32_t preset = options.preset | (options.extreme ? LZMA_PRESET_EXTREME : 0);
+
+    if (lzma_lzma_preset(&lzmaOptions, preset)) {
+        throw std::runtime_error("Compression could not start!");
+    }
+
+    if (options.dictionarySize != 0) {
+        lzmaOptions.dict_size = options.dictionarySize;
+    }
+
+    lzma_filter filters[] = {
+        { LZMA_FILTER_LZMA2, &lzmaOptions },
+        { LZMA_VLI_UNKNOWN, nullptr }
+    };
+
+    uint32_t threadCount = lzmaThreadCount(options);
+    lzma_ret ret;
+
+    if (threadCount > 1) {
+        lzma_mt mt = {};
+        mt.threads = threadCount;
+        mt.block_size = options.blockSize;
+        mt.filters = filters;
+        mt.check = toLZMACheck(options.check);
+
+        while (options.memoryLimit != 0 && mt.threads > 1
+               && lzma_stream_encoder_mt_memusage(&mt) > options.memoryLimit) {
+            --mt.threads;
+        }
+
+        ret = lzma_stream_encoder_mt(&strm, &mt);
+    } else {
+        ret = lzma_stream_encoder(&strm, filters, toLZMACheck(options.check));
+    }
+
+    if (ret != LZMA_OK) {
+        throw std::runtime_error("Compression could not start!");
+    }
+}
+
+static void initLZMA2Decoder(lzma_stream &strm, const LZMA2Options &options)
+{
+    uint64_t memoryLimit = (options.memoryLimit != 0) ? options.memoryLimit : UINT64_MAX;
+    lzma_ret ret;
+
+#if LZMA_VERSION >= 50040002
+    uint32_t threadCount = lzmaThreadCount(options);
+
+    if (threadCount > 1) {
+        lzma_mt mt = {};
+        mt.flags = LZMA_CONCATENATED;
+        mt.threads = threadCount;
+        mt.memlimit_threading = memoryLimit;
+        mt.memlimit_stop = memoryLimit;
+        ret = lzma_stream_decoder_mt(&strm, &mt);
+    } else {
+        ret = lzma_stream_decoder(&strm, memoryLimit, LZMA_CONCATENATED);
+    }
+#else
+    ret = lzma_stream_decoder(&strm, memoryLimit, LZMA_CONCATENATED);
+#endif
+
+    if (ret != LZMA_OK) {
+        throw std::runtime_error("Decompression could not start!");
+    }
+}
+
+// Pulls input views from source until it returns an empty one and pushes the
+// output through a fixed buffer, so neither side has to be sized in advance
+static void codeLZMA(lzma_stream &strm, const std::function<ByteView()> &source,
+                     const std::function<void(const uint8_t *, size_t)> &sink)
+{
+    std::vector<uint8_t> outBuffer(LZMABufferSize);
+    lzma_action action = LZMA_RUN;
+
+    strm.next_out = outBuffer.data();
+    strm.avail_out = outBuffer.size();
+
+    try {
+        while (true) {
+            if (strm.avail_in == 0 && action == LZMA_RUN) {
+                ByteView chunk = source();
+                strm.next_in = chunk.data();
+                strm.avail_in = chunk.size();
+
+                if (chunk.empty()) {
+                    action = LZMA_FINISH;
+                }
+            }
+
+            lzma_ret ret = lzma_code(&strm, action);
+
+            if (strm.avail_out == 0 || ret == LZMA_STREAM_END) {
+                sink(outBuffer.data(), outBuffer.size() - strm.avail_out);
+                strm.next_out = outBuffer.data();
+                strm.avail_out = outBuffer.size();
+            }
+
+            if (ret == LZMA_STREAM_END) {
+                break;
+            }
+
+            if (ret != LZMA_OK) {
+                throw std::runtime_error("LZMA coding is failed!");
+            }
+        }
+    } catch (...) {
+        lzma_end(&strm);
+        throw;
+    }
+
+    lzma_end(&strm);
+}
+
+static bool codeLZMAFile(lzma_stream &strm, const std::string &inputFileName, const std::string &outputFileName)
+{
+    FileReader inputFile(inputFileName);
+
+    if (!inputFile.isOpen()) {
+        lzma_end(&strm);
+        return false;
+    }
+
+    FileWriter outputFile(outputFileName);
+
+    if (!outputFile.isOpen()) {
+        lzma_end(&strm);
+        return false;
+    }
+
+    std::vector<uint8_t> chunk;
+
+    codeLZMA(strm, [&inputFile, &chunk]() {
+        inputFile.readChunk(chunk);
+        return ByteView(chunk);
+    }, [&outputFile](const uint8_t *buffer, size_t size) {
+        outputFile.write(buffer, size);
+    });
+
+    outputFile.close();
+    return true;
+}
+
+struct CompressionAlgorithms::LZMA2ChunkCoder::Stream {
+    lzma_stream strm = LZMA_STREAM_INIT;
+    bool finished = false;
+};
+
+CompressionAlgorithms::LZMA2ChunkCoder::LZMA2ChunkCoder(bool encoder, const LZMA2Options &options) :
+    m_stream(new Stream)
+{
+    if (encoder) {
+        initLZMA2Encoder(m_stream->strm, options);
+    } else {
+        initLZMA2Decoder(m_stream->strm, options);
+    }
+}
+
+CompressionAlgorithms::LZMA2ChunkCoder::~LZMA2ChunkCoder()
+{
+    lzma_end(&m_stream->strm);
+}
+
+void CompressionAlgorithms::LZMA2ChunkCoder::code(std::vector<uint8_t> &chunk, bool last)
+{
+    if (chunk.empty() && !last) {
+        return;
+    }
+
+    lzma_stream &strm = m_stream->strm;
+    lzma_action action = last ? LZMA_FINISH : LZMA_RUN;
+    std::vector<uint8_t> output(std::max(LZMABufferSize / 16, chunk.size() / 2));
+    size_t outputSize = 0;
+
+    if (m_stream->finished) {
+        throw std::runtime_error("LZMA coding is failed!");
+    }
+
+    strm.next_in = chunk.data();
+    strm.avail_in = chunk.size();
+
+    while (true) {
+        if (outputSize == output.size()) {
+            output.resize(output.size() * 2);
+        }
+
+        strm.next_out = output.data() + outputSize;
+        strm.avail_out = output.size() - outputSize;
+
+        lzma_ret ret = lzma_code(&strm, action);
+        outputSize = output.size() - strm.avail_out;
+
+        if (ret == LZMA_STREAM_END) {
+            m_stream->finished = true;
+            break;
+        }
+
+        if (ret != LZMA_OK) {
+            throw std::runtime_error("LZMA coding is failed!");
+        }
+
+        // Without more input a running coder stops once it leaves space
+        if (action == LZMA_RUN && strm.avail_in == 0 && strm.avail_out != 0) {
+            break;
+        }
+    }
+
+    output.resize(outputSize);
+    chunk = std::move(output);
+}
+
 CompressionAlgorithms::CompressionAlgorithms()
 {
 
@@ -35,27 +597,23 @@ CompressionAlgorithms::~CompressionAlgorithms()
 }
 
 bool CompressionAlgorithms::compressFile(const std::string &inputFileName, const std::string &outputFileName,
-        std::function<std::vector<uint8_t>(const std::vector<uint8_t> &data)> compressAlgorithm)
+        std::function<std::vector<uint8_t>(const ByteView &data)> compressAlgorithm)
 {
-    std::ifstream inputFile(inputFileName, std::ios::binary);
+    MappedFile inputFile(inputFileName);
 
-    if (!inputFile) {
+    if (!inputFile.isOpen()) {
         return false;
     }
 
-    std::vector<uint8_t> inputData((std::istreambuf_iterator<char>(inputFile)),
-                                   std::istreambuf_iterator<char>());
-    inputFile.close();
-
     try {
-        std::vector<uint8_t> compressedData = compressAlgorithm(inputData);
-        std::ofstream outputFile(outputFileName, std::ios::binary);
+        std::vector<uint8_t> compressedData = compressAlgorithm(inputFile.view());
+        FileWriter outputFile(outputFileName);
 
-        if (!outputFile) {
+        if (!outputFile.isOpen()) {
             return false;
         }
 
-        outputFile.write(reinterpret_cast<char *>(compressedData.data()), compressedData.size());
+        outputFile.write(compressedData);
         outputFile.close();
     } catch (const std::exception &e) {
         return false;
@@ -65,27 +623,23 @@ bool CompressionAlgorithms::compressFile(const std::string &inputFileName, const
 }
 
 bool CompressionAlgorithms::decompressFile(const std::string &inputFileName, const std::string &outputFileName,
-        std::function<std::vector<uint8_t>(const std::vector<uint8_t> &data)> decompressAlgorithm)
+        std::function<std::vector<uint8_t>(const ByteView &data)> decompressAlgorithm)
 {
-    std::ifstream inputFile(inputFileName, std::ios::binary);
+    MappedFile inputFile(inputFileName);
 
-    if (!inputFile) {
+    if (!inputFile.isOpen()) {
         return false;
     }
 
-    std::vector<uint8_t> compressedData((std::istreambuf_iterator<char>(inputFile)),
-                                        std::istreambuf_iterator<char>());
-    inputFile.close();
-
     try {
-        std::vector<uint8_t> rawData = decompressAlgorithm(compressedData);
-        std::ofstream outputFile(outputFileName, std::ios::binary);
+        std::vector<uint8_t> rawData = decompressAlgorithm(inputFile.view());
+        FileWriter outputFile(outputFileName);
 
-        if (!outputFile) {
+        if (!outputFile.isOpen()) {
             return false;
         }
 
-        outputFile.write(reinterpret_cast<char *>(rawData.data()), rawData.size());
+        outputFile.write(rawData);
         outputFile.close();
     } catch (const std::exception &e) {
         return false;
@@ -94,340 +648,662 @@ bool CompressionAlgorithms::decompressFile(const std::string &inputFileName, con
     return true;
 }
 
-std::vector<uint8_t> CompressionAlgorithms::compressWithLZMA2(const std::vector<uint8_t> &data)
+std::vector<uint8_t> CompressionAlgorithms::compressWithLZMA2(const ByteView &data, const LZMA2Options &options)
 {
     lzma_stream strm = LZMA_STREAM_INIT;
-    lzma_ret ret = lzma_easy_encoder(&strm, LZMA_PRESET_DEFAULT, LZMA_CHECK_CRC64);
-    if (ret != LZMA_OK) {
-        throw std::runtime_error("Compression could not start!");
-    }
+    initLZMA2Encoder(strm, options);
+
+    std::vector<uint8_t> compressedData;
+    compressedData.reserve(data.size() / 2 + 128);
+    bool pending = true;
+
+    codeLZMA(strm, [&data, &pending]() {
+        ByteView chunk = pending ? data : ByteView();
+        pending = false;
+        return chunk;
+    }, [&compressedData](const uint8_t *buffer, size_t size) {
+        compressedData.insert(compressedData.end(), buffer, buffer + size);
+    });
+
+    return compressedData;
+}
+
+std::vector<uint8_t> CompressionAlgorithms::decompressWithLZMA2(const ByteView &compressedData,
+        const LZMA2Options &options)
+{
+    lzma_stream strm = LZMA_STREAM_INIT;
+    initLZMA2Decoder(strm, options);
+
+    std::vector<uint8_t> rawData;
+    rawData.reserve(compressedData.size() * 3);
+    bool pending = true;
 
-    strm.next_in = data.data();
-    strm.avail_in = data.size();
+    codeLZMA(strm, [&compressedData, &pending]() {
+        ByteView chunk = pending ? compressedData : ByteView();
+        pending = false;
+        return chunk;
+    }, [&rawData](const uint8_t *buffer, size_t size) {
+        rawData.insert(rawData.end(), buffer, buffer + size);
+    });
+
+    return rawData;
+}
+
+std::vector<uint8_t> CompressionAlgorithms::compressWithLZ77(const ByteView &data, const LZ77Options &options)
+{
+    size_t dataSize = data.size();
+    size_t pos = 0;
 
     std::vector<uint8_t> compressedData;
-    compressedData.resize(data.size() + data.size() / 3 + 128);
+    compressedData.reserve(dataSize);
 
-    strm.next_out = compressedData.data();
-    strm.avail_out = compressedData.size();
+    MatchFinder matchFinder(data.data(), dataSize, LZ77WindowSize, options.searchDepth);
 
-    ret = lzma_code(&strm, LZMA_FINISH);
-    if (ret != LZMA_STREAM_END) {
-        lzma_end(&strm);
-        throw std::runtime_error("Compression is failed!");
+    // Every token carries the byte after its match, so a match never
+    // reaches the last byte of the data
+    auto findMatch = [&](size_t position) {
+        size_t maxLength = std::min(LZ77MaxLength, dataSize - position - 1);
+        return matchFinder.find(position, maxLength);
+    };
+
+    auto putToken = [&](const MatchFinder::Match &match) {
+        LZ77Token token = { static_cast<uint16_t>(match.offset), static_cast<uint16_t>(match.length),
+                            data[pos + match.length]
+                          };
+        compressedData.push_back(static_cast<uint8_t>(token.offset >> 8));
+        compressedData.push_back(static_cast<uint8_t>(token.offset & 0xFF));
+        compressedData.push_back(static_cast<uint8_t>(token.length));
+        compressedData.push_back(token.nextChar);
+        pos += match.length + 1;
+    };
+
+    if (options.parsing == LZ77Options::ParsingOptimal) {
+        std::vector<uint16_t> offsets(dataSize);
+        std::vector<uint8_t> lengths(dataSize);
+
+        for (size_t i = 0; i < dataSize; ++i) {
+            MatchFinder::Match match = findMatch(i);
+            offsets[i] = static_cast<uint16_t>(match.offset);
+            lengths[i] = static_cast<uint8_t>(match.length);
+        }
+
+        // tokenCount[i] is the fewest tokens which encode data[i..], any
+        // prefix of the longest match is a match as well
+        std::vector<uint32_t> tokenCount(dataSize + 1, 0);
+
+        for (size_t i = dataSize; i-- > 0;) {
+            uint32_t best = UINT32_MAX;
+            uint8_t bestLength = 0;
+
+            for (size_t length = lengths[i] + 1; length-- > 0;) {
+                if (tokenCount[i + length + 1] < best) {
+                    best = tokenCount[i + length + 1];
+                    bestLength = static_cast<uint8_t>(length);
+                }
+            }
+
+            tokenCount[i] = best + 1;
+            lengths[i] = bestLength;
+        }
+
+        while (pos < dataSize) {
+            MatchFinder::Match match;
+            match.length = lengths[pos];
+            match.offset = match.length > 0 ? offsets[pos] : 0;
+            putToken(match);
+        }
+
+        return compressedData;
+    }
+
+    // Lazy parsing looks one token ahead, the matches of the positions it
+    // may continue from are kept in a ring
+    MatchFinder::Match lookahead[LZ77LookaheadSize];
+    size_t lookaheadEnd = 0;
+
+    auto matchAt = [&](size_t position) {
+        for (; lookaheadEnd <= position; ++lookaheadEnd) {
+            lookahead[lookaheadEnd % LZ77LookaheadSize] = findMatch(lookaheadEnd);
+        }
+
+        return lookahead[position % LZ77LookaheadSize];
+    };
+
+    while (pos < dataSize) {
+        if (options.parsing == LZ77Options::ParsingGreedy) {
+            putToken(findMatch(pos));
+            continue;
+        }
+
+        MatchFinder::Match match = matchAt(pos);
+        size_t bestReach = 0;
+        size_t bestLength = 0;
+
+        // A shorter match pays off when the token after it reaches further
+        for (size_t length = match.length + 1; length-- > 0;) {
+            size_t next = pos + length + 1;
+            size_t reach = length + 1 + ((next < dataSize) ? matchAt(next).length + 1 : 0);
+
+            if (reach > bestReach) {
+                bestReach = reach;
+                bestLength = length;
+            }
+        }
+
+        match.length = bestLength;
+        match.offset = (bestLength > 0) ? match.offset : 0;
+        putToken(match);
     }
 
-    compressedData.resize(compressedData.size() - strm.avail_out);
-    lzma_end(&strm);
     return compressedData;
 }
 
-std::vector<uint8_t> CompressionAlgorithms::decompressWithLZMA2(const std::vector<uint8_t>
-        &compressedData)
+std::vector<uint8_t> CompressionAlgorithms::decompressWithLZ77(const ByteView &compressedData)
 {
-    lzma_stream strm = LZMA_STREAM_INIT;
-    lzma_ret ret = lzma_stream_decoder(&strm, UINT64_MAX, LZMA_CONCATENATED);
+    size_t dataSize = compressedData.size();
 
-    if (ret != LZMA_OK) {
-        throw std::runtime_error("Decompression could not start!");
+    // A match copies nothing when its offset is zero, longer offsets are
+    // clamped to the output size
+    auto tokenLength = [&compressedData](size_t pos, size_t outputSize) {
+        uint16_t offset = (static_cast<uint16_t>(compressedData[pos]) << 8)
+                          | static_cast<uint16_t>(compressedData[pos + 1]);
+        return (offset == 0 || outputSize == 0) ? 0 : static_cast<size_t>(compressedData[pos + 2]);
+    };
+
+    size_t outputSize = 0;
+
+    for (size_t pos = 0; pos + 4 <= dataSize; pos += 4) {
+        outputSize += tokenLength(pos, outputSize) + 1;
     }
 
-    strm.next_in = compressedData.data();
-    strm.avail_in = compressedData.size();
+    std::vector<uint8_t> data(outputSize + WildCopySlack);
+    uint8_t *output = data.data();
 
-    std::vector<uint8_t> rawData;
-    rawData.resize(compressedData.size() * 3);
+    for (size_t pos = 0; pos + 4 <= dataSize; pos += 4) {
+        size_t offset = (static_cast<size_t>(compressedData[pos]) << 8) | compressedData[pos + 1];
+        size_t length = tokenLength(pos, output - data.data());
 
-    strm.next_out = rawData.data();
-    strm.avail_out = rawData.size();
+        if (length > 0) {
+            copyMatch(output, std::min<size_t>(offset, output - data.data()), length);
+            output += length;
+        }
 
-    ret = lzma_code(&strm, LZMA_FINISH);
-    if (ret != LZMA_STREAM_END) {
-        lzma_end(&strm);
-        throw std::runtime_error("Decompression is failed!");
+        *output++ = compressedData[pos + 3];
     }
 
-    rawData.resize(rawData.size() - strm.avail_out);
-    lzma_end(&strm);
-    return rawData;
+    data.resize(outputSize);
+    return data;
 }
 
-std::vector<uint8_t> CompressionAlgorithms::compressWithLZ77(const std::vector<uint8_t> &data)
+std::vector<uint8_t> CompressionAlgorithms::compressWithLZSS(const ByteView &data, const LZSSOptions &options)
 {
-    const size_t WINDOW_SIZE = 4096;
-    const size_t LOOKAHEAD_BUFFER_SIZE = 18;
+    if (options.windowBits < LZSSMinWindowBits || options.windowBits > LZSSMaxWindowBits) {
+        throw std::runtime_error("Invalid LZSS window size!");
+    }
 
     size_t dataSize = data.size();
     size_t pos = 0;
 
     std::vector<uint8_t> compressedData;
-    compressedData.reserve(dataSize);
+    compressedData.reserve(dataSize / 2 + LZHeaderSize);
+    putLZHeader(compressedData, LZSSMagic, static_cast<uint8_t>(options.windowBits), dataSize);
+
+    MatchFinder matchFinder(data.data(), dataSize, size_t(1) << options.windowBits, options.searchDepth);
+
+    // Matches which do not save space over their literals are dropped
+    auto findMatch = [&](size_t position) {
+        MatchFinder::Match match = matchFinder.find(position, LZSSMaxLength);
+
+        if (match.length < LZSSMinLength || lzssMatchSize(match.offset, match.length) >= match.length) {
+            match = MatchFinder::Match();
+        }
+
+        return match;
+    };
+
+    size_t flagPos = 0;
+    unsigned flagBit = 8;
+
+    auto putFlag = [&](bool isMatch) {
+        if (flagBit == 8) {
+            flagPos = compressedData.size();
+            compressedData.push_back(0);
+            flagBit = 0;
+        }
+
+        if (isMatch) {
+            compressedData[flagPos] |= static_cast<uint8_t>(1 << flagBit);
+        }
+
+        ++flagBit;
+    };
+
+    MatchFinder::Match next;
+    bool hasNext = false;
 
     while (pos < dataSize) {
-        uint16_t bestOffset = 0;
-        uint16_t bestLength = 0;
-
-        size_t startWindow = (pos >= WINDOW_SIZE) ? pos - WINDOW_SIZE : 0;
-        size_t endWindow = pos;
-
-        for (size_t i = startWindow; i < endWindow; ++i) {
-            size_t matchLength = 0;
-            while (matchLength < LOOKAHEAD_BUFFER_SIZE &&
-                   (pos + matchLength) < dataSize &&
-                   (i + matchLength) < dataSize &&
-                   data[i + matchLength] == data[pos + matchLength]) {
-                matchLength++;
-            }
+        MatchFinder::Match match = hasNext ? next : findMatch(pos);
+        hasNext = false;
 
-            if (matchLength > bestLength) {
-                bestLength = static_cast<uint16_t>(matchLength);
-                bestOffset = static_cast<uint16_t>(pos - i);
+        if (options.lazy && match.length > 0 && pos + 1 < dataSize) {
+            next = findMatch(pos + 1);
+            hasNext = true;
+
+            if (next.length > match.length) {
+                match = MatchFinder::Match();
             }
         }
 
-        uint8_t nextChar = (pos + bestLength < dataSize)
-                           ? data[pos + bestLength]
-                           : 0;
+        if (match.length == 0) {
+            putFlag(false);
+            compressedData.push_back(data[pos]);
+            ++pos;
+            continue;
+        }
 
-        LZ77Token token = { bestOffset, bestLength, nextChar };
-        compressedData.push_back(static_cast<uint8_t>(token.offset >> 8));
-        compressedData.push_back(static_cast<uint8_t>(token.offset & 0xFF));
-        compressedData.push_back(static_cast<uint8_t>(token.length));
-        compressedData.push_back(token.nextChar);
-        pos += bestLength + 1;
+        size_t lengthCode = match.length - LZSSMinLength;
+        putFlag(true);
+        putVarint(compressedData, ((match.offset - 1) << LZSSLengthBits) | std::min(lengthCode, LZSSLengthMask));
+
+        if (lengthCode >= LZSSLengthMask) {
+            putVarint(compressedData, lengthCode - LZSSLengthMask);
+        }
+
+        pos += match.length;
+        hasNext = false;
     }
 
     return compressedData;
 }
 
-std::vector<uint8_t> CompressionAlgorithms::decompressWithLZ77(const std::vector<uint8_t> &compressedData)
+std::vector<uint8_t> CompressionAlgorithms::decompressWithLZSS(const ByteView &compressedData)
 {
-    size_t pos = 0;
-    size_t dataSize = compressedData.size();
-    std::vector<uint8_t> data;
-    data.reserve(dataSize * 2);
+    uint8_t windowBits = 0;
+    uint64_t dataSize = 0;
 
-    while (pos + 4 <= dataSize) {
-        uint16_t offset = (static_cast<uint16_t>(compressedData[pos]) << 8)
-                          | static_cast<uint16_t>(compressedData[pos + 1]);
-        uint16_t length = compressedData[pos + 2];
-        uint8_t nextChar = compressedData[pos + 3];
-        pos += 4;
+    if (!getLZHeader(compressedData, LZSSMagic, windowBits, dataSize)) {
+        throw std::runtime_error("Invalid LZSS header!");
+    }
 
-        if (offset > data.size()) {
-            offset = static_cast<uint16_t>(data.size());
-        }
+    // A token takes at least one byte and the match check below rejects any
+    // token longer than the maximum length
+    if (dataSize / LZSSMaxLength > compressedData.size()) {
+        throw std::runtime_error("Invalid LZSS header!");
+    }
 
-        size_t start = data.size() - offset;
+    std::vector<uint8_t> data(dataSize + WildCopySlack);
+    size_t pos = LZHeaderSize;
+    size_t dataPos = 0;
+    uint8_t flags = 0;
+    unsigned flagBit = 8;
 
-        for (uint16_t i = 0; i < length; ++i) {
-            if ((start + i) < data.size()) {
-                data.push_back(data[start + i]);
-            } else {
-                break;
+    while (dataPos < dataSize) {
+        if (flagBit == 8) {
+            if (pos >= compressedData.size()) {
+                throw std::runtime_error("LZSS data is truncated!");
             }
+
+            flags = compressedData[pos++];
+            flagBit = 0;
+
+            // Eight literals in a row are copied at once
+            if (flags == 0 && pos + 8 <= compressedData.size() && dataPos + 8 <= dataSize) {
+                std::memcpy(&data[dataPos], &compressedData[pos], 8);
+                pos += 8;
+                dataPos += 8;
+                flagBit = 8;
+                continue;
+            }
+        }
+
+        if (!((flags >> flagBit++) & 1)) {
+            if (pos >= compressedData.size()) {
+                throw std::runtime_error("LZSS data is truncated!");
+            }
+
+            data[dataPos++] = compressedData[pos++];
+            continue;
         }
 
-        data.push_back(nextChar);
+        uint64_t code = getVarint(compressedData, pos);
+        uint64_t offset = (code >> LZSSLengthBits) + 1;
+        uint64_t length = (code & LZSSLengthMask) + LZSSMinLength;
+
+        if ((code & LZSSLengthMask) == LZSSLengthMask) {
+            length += getVarint(compressedData, pos);
+        }
+
+        if (offset > dataPos || length > LZSSMaxLength || length > dataSize - dataPos) {
+            throw std::runtime_error("Invalid LZSS match!");
+        }
+
+        copyMatch(&data[dataPos], offset, length);
+        dataPos += length;
     }
 
+    data.resize(dataSize);
     return data;
 }
 
-std::vector<uint8_t> CompressionAlgorithms::compressWithLZ78(const std::vector<uint8_t> &data)
+std::vector<uint8_t> CompressionAlgorithms::compressWithLZ78(const ByteView &data, const LZWOptions &options)
 {
-    std::map<std::vector<uint8_t>, uint16_t> dictionary;
-    uint16_t dictSize = 1;
+    checkCodeBits(options.maxBits);
+
+    uint32_t maxCodes = uint32_t(1) << options.maxBits;
+    PhraseTrie dictionary(maxCodes);
+    uint32_t dictSize = LZ78FirstCode;
+    unsigned bits = LZMinCodeBits;
+    DictionaryResetMonitor monitor;
 
     std::vector<uint8_t> compressedData;
-    compressedData.reserve(data.size() * 3);
+    compressedData.reserve(data.size() + LZHeaderSize);
+    putLZHeader(compressedData, LZ78Magic, static_cast<uint8_t>(options.maxBits), data.size());
+
+    BitWriter writer(compressedData);
+
+    // Code zero is the empty phrase
+    uint32_t w = 0;
 
-    std::vector<uint8_t> w;
     for (size_t i = 0; i < data.size(); ++i) {
         uint8_t c = data[i];
-        std::vector<uint8_t> wc = w;
-        wc.push_back(c);
+        uint32_t wc = dictionary.find(w, c);
 
-        auto it = dictionary.find(wc);
-        if (it != dictionary.end()) {
+        if (wc != PhraseTrie::NoCode) {
             w = wc;
-        } else {
-            uint16_t index = 0;
-            if (!w.empty()) {
-                index = dictionary[w];
-            }
-
-            compressedData.push_back(static_cast<uint8_t>(index >> 8));
-            compressedData.push_back(static_cast<uint8_t>(index & 0xFF));
-            compressedData.push_back(c);
+            continue;
+        }
 
-            dictionary[wc] = dictSize++;
-            w.clear();
+        writer.write(w, bits);
+        writer.write(c, 8);
+
+        if (dictSize < maxCodes) {
+            dictionary.insert(w, c, dictSize++);
+            bits = codeBits(dictSize);
+        } else if (options.adaptiveReset && monitor.check(i + 1, writer.bitsWritten())) {
+            writer.write(LZ78ClearCode, bits);
+            dictionary.clear();
+            dictSize = LZ78FirstCode;
+            bits = LZMinCodeBits;
         }
+
+        w = 0;
     }
 
-    if (!w.empty()) {
-        uint16_t index = dictionary[w];
-        compressedData.push_back(static_cast<uint8_t>(index >> 8));
-        compressedData.push_back(static_cast<uint8_t>(index & 0xFF));
-        compressedData.push_back(0);
+    // The last phrase may be unfinished, its byte is cut off by the size
+    if (w != 0) {
+        writer.write(w, bits);
+        writer.write(0, 8);
     }
 
+    writer.flush();
     return compressedData;
 }
 
-std::vector<uint8_t> CompressionAlgorithms::decompressWithLZ78(const std::vector<uint8_t> &compressedData)
+std::vector<uint8_t> CompressionAlgorithms::decompressWithLZ78(const ByteView &compressedData)
 {
-    std::vector<std::vector<uint8_t>> dictionary;
-    dictionary.push_back(std::vector<uint8_t>());
+    uint8_t maxBits = 0;
+    uint64_t dataSize = 0;
+
+    if (!getLZHeader(compressedData, LZ78Magic, maxBits, dataSize)
+            || !isPlausiblePhraseOutput(dataSize, compressedData.size() - LZHeaderSize)) {
+        throw std::runtime_error("Invalid LZ78 header!");
+    }
 
-    std::vector<uint8_t> decompressedData;
-    size_t position = 0;
+    checkCodeBits(maxBits);
 
-    while (position + 3 <= compressedData.size()) {
-        uint16_t index = (static_cast<uint16_t>(compressedData[position]) << 8)
-                         | static_cast<uint16_t>(compressedData[position + 1]);
-        position += 2;
+    uint32_t maxCodes = uint32_t(1) << maxBits;
+    std::vector<PhraseEntry> dictionary(maxCodes);
+    uint32_t dictSize = LZ78FirstCode;
+    unsigned bits = LZMinCodeBits;
 
-        uint8_t c = compressedData[position];
-        position++;
+    std::vector<uint8_t> decompressedData(dataSize);
+    uint8_t *output = decompressedData.data();
+    uint64_t pos = 0;
+    BitReader reader(compressedData.subview(LZHeaderSize, compressedData.size() - LZHeaderSize));
 
-        std::vector<uint8_t> entry;
-        if (index < dictionary.size()) {
-            entry = dictionary[index];
-        } else {
-            break;
+    while (pos < dataSize) {
+        uint32_t index = reader.read(bits);
+
+        if (index == LZ78ClearCode) {
+            dictSize = LZ78FirstCode;
+            bits = LZMinCodeBits;
+            continue;
         }
 
-        if (c != 0) {
-            entry.push_back(c);
+        uint8_t c = static_cast<uint8_t>(reader.read(8));
+
+        if (index >= dictSize || dictionary[index].length > dataSize - pos) {
+            throw std::runtime_error("Invalid LZ78 code!");
         }
 
-        decompressedData.insert(decompressedData.end(), entry.begin(), entry.end());
-        dictionary.push_back(entry);
+        // The byte of the last phrase is cut off by the size
+        writePhrase(dictionary.data(), index, output + pos);
+        pos += dictionary[index].length;
+
+        if (pos < dataSize) {
+            output[pos++] = c;
+        }
+
+        if (dictSize < maxCodes) {
+            dictionary[dictSize] = { index, dictionary[index].length + 1, c };
+            bits = codeBits(++dictSize);
+        }
     }
 
     return decompressedData;
 }
 
-std::vector<uint8_t> CompressionAlgorithms::compressWithLZW(const std::vector<uint8_t> &data)
+std::vector<uint8_t> CompressionAlgorithms::compressWithLZW(const ByteView &data, const LZWOptions &options)
 {
-    std::map<std::vector<uint8_t>, uint16_t> dictionary;
-    uint16_t dictSize = 256;
+    checkCodeBits(options.maxBits);
 
-    for (uint16_t i = 0; i < 256; ++i) {
-        dictionary[ {static_cast<uint8_t>(i)}] = i;
-    }
+    // Codes below 256 are the single byte phrases
+    uint32_t maxCodes = uint32_t(1) << options.maxBits;
+    PhraseTrie dictionary(maxCodes);
+    uint32_t dictSize = LZWFirstCode;
+    unsigned bits = LZMinCodeBits;
+    DictionaryResetMonitor monitor;
 
     std::vector<uint8_t> compressedData;
-    compressedData.reserve(data.size() * 2);
+    compressedData.reserve(data.size() + LZHeaderSize);
+    putLZHeader(compressedData, LZWMagic, static_cast<uint8_t>(options.maxBits), data.size());
 
     if (data.empty()) {
         return compressedData;
     }
 
-    std::vector<uint8_t> w;
-    w.push_back(data[0]);
+    BitWriter writer(compressedData);
+    uint32_t w = data[0];
 
     for (size_t i = 1; i < data.size(); ++i) {
         uint8_t k = data[i];
-        std::vector<uint8_t> wk = w;
-        wk.push_back(k);
+        uint32_t wk = dictionary.find(w, k);
 
-        auto it = dictionary.find(wk);
-
-        if (it != dictionary.end()) {
+        if (wk != PhraseTrie::NoCode) {
             w = wk;
-        } else {
-            uint16_t code = dictionary[w];
-            compressedData.push_back(static_cast<uint8_t>(code >> 8));
-            compressedData.push_back(static_cast<uint8_t>(code & 0xFF));
+            continue;
+        }
 
-            dictionary[wk] = dictSize++;
+        writer.write(w, bits);
 
-            w.clear();
-            w.push_back(k);
+        if (dictSize < maxCodes) {
+            dictionary.insert(w, k, dictSize++);
+            bits = codeBits(dictSize);
+        } else if (options.adaptiveReset && monitor.check(i, writer.bitsWritten())) {
+            writer.write(LZWClearCode, bits);
+            dictionary.clear();
+            dictSize = LZWFirstCode;
+            bits = LZMinCodeBits;
         }
-    }
 
-    if (!w.empty()) {
-        uint16_t code = dictionary[w];
-        compressedData.push_back(static_cast<uint8_t>(code >> 8));
-        compressedData.push_back(static_cast<uint8_t>(code & 0xFF));
+        w = k;
     }
 
+    writer.write(w, bits);
+    writer.flush();
+
     return compressedData;
 }
 
-std::vector<uint8_t> CompressionAlgorithms::decompressWithLZW(const std::vector<uint8_t> &compressedData)
+std::vector<uint8_t> CompressionAlgorithms::decompressWithLZW(const ByteView &compressedData)
 {
-    std::vector<std::vector<uint8_t>> dictionary(256);
-    for (uint16_t i = 0; i < 256; ++i) {
-        dictionary[i] = { static_cast<uint8_t>(i) };
+    uint8_t maxBits = 0;
+    uint64_t dataSize = 0;
+
+    if (!getLZHeader(compressedData, LZWMagic, maxBits, dataSize)
+            || !isPlausiblePhraseOutput(dataSize, compressedData.size() - LZHeaderSize)) {
+        throw std::runtime_error("Invalid LZW header!");
     }
 
-    std::vector<uint8_t> data;
-    data.reserve(compressedData.size() * 3);
+    checkCodeBits(maxBits);
 
-    size_t pos = 0;
-    size_t dataSize = compressedData.size();
+    uint32_t maxCodes = uint32_t(1) << maxBits;
+    std::vector<PhraseEntry> dictionary(maxCodes);
+    uint32_t dictSize = LZWFirstCode;
 
-    if (dataSize < 2) {
-        return data;
+    for (uint32_t i = 0; i < 256; ++i) {
+        dictionary[i] = { PhraseEntry::NoPrefix, 1, static_cast<uint8_t>(i) };
     }
 
-    uint16_t code = (static_cast<uint16_t>(compressedData[pos]) << 8)
-                    | static_cast<uint16_t>(compressedData[pos + 1]);
-    pos += 2;
+    std::vector<uint8_t> data(dataSize);
+    uint8_t *output = data.data();
+    uint64_t pos = 0;
+    BitReader reader(compressedData.subview(LZHeaderSize, compressedData.size() - LZHeaderSize));
+    uint32_t w = PhraseEntry::NoPrefix;
 
-    if (code >= dictionary.size()) {
-        std::cerr << "Failed: Invalid code (First code)." << std::endl;
-        return data;
-    }
+    while (pos < dataSize) {
+        // The decoder adds every entry one code after the encoder
+        bool hasPrevious = w != PhraseEntry::NoPrefix;
+        uint32_t code = reader.read(codeBits(std::min(maxCodes, dictSize + hasPrevious)));
+
+        if (code == LZWClearCode) {
+            dictSize = LZWFirstCode;
+            w = PhraseEntry::NoPrefix;
+            continue;
+        }
 
-    std::vector<uint8_t> w = dictionary[code];
-    data.insert(data.end(), w.begin(), w.end());
+        uint64_t length;
 
-    while (pos + 2 <= dataSize) {
-        code = (static_cast<uint16_t>(compressedData[pos]) << 8)
-               | static_cast<uint16_t>(compressedData[pos + 1]);
-        pos += 2;
+        if (code < dictSize) {
+            length = dictionary[code].length;
+
+            if (length > dataSize - pos) {
+                throw std::runtime_error("Invalid LZW code!");
+            }
+
+            writePhrase(dictionary.data(), code, output + pos);
+        } else if (code == dictSize && hasPrevious) {
+            // The new phrase is the previous one followed by its first byte
+            length = dictionary[w].length + 1;
+
+            if (length > dataSize - pos) {
+                throw std::runtime_error("Invalid LZW code!");
+            }
 
-        std::vector<uint8_t> entry;
-        if (code < dictionary.size()) {
-            entry = dictionary[code];
-        } else if (code == dictionary.size()) {
-            entry = w;
-            entry.push_back(w[0]);
+            writePhrase(dictionary.data(), w, output + pos);
+            output[pos + length - 1] = output[pos];
         } else {
-            std::cerr << "Failed: Invalid code." << std::endl;
-            break;
+            throw std::runtime_error("Invalid LZW code!");
         }
 
-        data.insert(data.end(), entry.begin(), entry.end());
+        if (hasPrevious && dictSize < maxCodes) {
+            dictionary[dictSize++] = { w, dictionary[w].length + 1, output[pos] };
+        }
 
-        std::vector<uint8_t> newEntry = w;
-        newEntry.push_back(entry[0]);
-        dictionary.push_back(newEntry);
-        w = entry;
+        pos += length;
+        w = code;
     }
 
     return data;
 }
 
-bool CompressionAlgorithms::compressFileWithLZMA2(const std::string &inputFileName, const std::string &outputFileName)
+std::vector<uint8_t> CompressionAlgorithms::compressWithRANS(const ByteView &data, size_t blockSize)
 {
-    return compressFile(inputFileName, outputFileName, &CompressionAlgorithms::compressWithLZMA2);
+    if (blockSize == 0 || blockSize > UINT32_MAX) {
+        throw std::runtime_error("Invalid rANS block size!");
+    }
+
+    std::vector<uint8_t> compressedData(RANSMagic, RANSMagic + sizeof(RANSMagic));
+    compressedData.reserve(data.size() + data.size() / 8 + 1024);
+
+    for (size_t offset = 0; offset < data.size(); offset += blockSize) {
+        size_t size = std::min(blockSize, data.size() - offset);
+        RANSCoder::encodeBlock(data.data() + offset, static_cast<uint32_t>(size), compressedData);
+    }
+
+    return compressedData;
+}
+
+std::vector<uint8_t> CompressionAlgorithms::decompressWithRANS(const ByteView &compressedData)
+{
+    if (compressedData.size() < sizeof(RANSMagic)
+            || std::memcmp(compressedData.data(), RANSMagic, sizeof(RANSMagic)) != 0) {
+        throw std::runtime_error("Invalid rANS header!");
+    }
+
+    std::vector<uint8_t> data;
+    size_t pos = sizeof(RANSMagic);
+
+    while (pos < compressedData.size()) {
+        RANSCoder::decodeBlock(compressedData, pos, data);
+    }
+
+    return data;
+}
+
+std::vector<uint8_t> CompressionAlgorithms::compressWithCM(const ByteView &data)
+{
+    std::vector<uint8_t> compressedData;
+    compressedData.reserve(LZHeaderSize + data.size() / 2 + 16);
+    putLZHeader(compressedData, CMMagic, CMMaxOrder, data.size());
+    ContextMixingCoder::encode(data.data(), data.size(), compressedData);
+    return compressedData;
+}
+
+std::vector<uint8_t> CompressionAlgorithms::decompressWithCM(const ByteView &compressedData)
+{
+    uint8_t maxOrder = 0;
+    uint64_t dataSize = 0;
+
+    if (!getLZHeader(compressedData, CMMagic, maxOrder, dataSize) || maxOrder != CMMaxOrder) {
+        throw std::runtime_error("Invalid context mixing header!");
+    }
+
+    std::vector<uint8_t> data;
+    ContextMixingCoder::decode(compressedData.subview(LZHeaderSize, compressedData.size() - LZHeaderSize), dataSize, data);
+    return data;
+}
+
+bool CompressionAlgorithms::compressFileWithLZMA2(const std::string &inputFileName, const std::string &outputFileName,
+        const LZMA2Options &options)
+{
+    try {
+        lzma_stream strm = LZMA_STREAM_INIT;
+        initLZMA2Encoder(strm, options);
+        return codeLZMAFile(strm, inputFileName, outputFileName);
+    } catch (const std::exception &e) {
+        return false;
+    }
 }
 
-bool CompressionAlgorithms::decompressFileWithLZMA2(const std::string &inputFileName, const std::string &outputFileName)
+bool CompressionAlgorithms::decompressFileWithLZMA2(const std::string &inputFileName, const std::string &outputFileName,
+        const LZMA2Options &options)
 {
-    return decompressFile(inputFileName, outputFileName, &CompressionAlgorithms::decompressWithLZMA2);
+    try {
+        lzma_stream strm = LZMA_STREAM_INIT;
+        initLZMA2Decoder(strm, options);
+        return codeLZMAFile(strm, inputFileName, outputFileName);
+    } catch (const std::exception &e) {
+        return false;
+    }
 }
 
-bool CompressionAlgorithms::compressFileWithLZ77(const std::string &inputFileName, const std::string &outputFileName)
+bool CompressionAlgorithms::compressFileWithLZ77(const std::string &inputFileName, const std::string &outputFileName,
+        const LZ77Options &options)
 {
-    return compressFile(inputFileName, outputFileName, &CompressionAlgorithms::compressWithLZ77);
+    return compressFile(inputFileName, outputFileName, [&options](const ByteView &data) {
+        return compressWithLZ77(data, options);
+    });
 }
 
 bool CompressionAlgorithms::decompressFileWithLZ77(const std::string &inputFileName, const std::string &outputFileName)
@@ -435,9 +1311,25 @@ bool CompressionAlgorithms::decompressFileWithLZ77(const std::string &inputFileN
     return decompressFile(inputFileName, outputFileName, &CompressionAlgorithms::decompressWithLZ77);
 }
 
-bool CompressionAlgorithms::compressFileWithLZ78(const std::string &inputFileName, const std::string &outputFileName)
+bool CompressionAlgorithms::compressFileWithLZSS(const std::string &inputFileName, const std::string &outputFileName,
+        const LZSSOptions &options)
 {
-    return compressFile(inputFileName, outputFileName, &CompressionAlgorithms::compressWithLZ78);
+    return compressFile(inputFileName, outputFileName, [&options](const ByteView &data) {
+        return compressWithLZSS(data, options);
+    });
+}
+
+bool CompressionAlgorithms::decompressFileWithLZSS(const std::string &inputFileName, const std::string &outputFileName)
+{
+    return decompressFile(inputFileName, outputFileName, &CompressionAlgorithms::decompressWithLZSS);
+}
+
+bool CompressionAlgorithms::compressFileWithLZ78(const std::string &inputFileName, const std::string &outputFileName,
+        const LZWOptions &options)
+{
+    return compressFile(inputFileName, outputFileName, [&options](const ByteView &data) {
+        return compressWithLZ78(data, options);
+    });
 }
 
 bool CompressionAlgorithms::decompressFileWithLZ78(const std::string &inputFileName, const std::string &outputFileName)
@@ -445,12 +1337,38 @@ bool CompressionAlgorithms::decompressFileWithLZ78(const std::string &inputFileN
     return decompressFile(inputFileName, outputFileName, &CompressionAlgorithms::decompressWithLZ78);
 }
 
-bool CompressionAlgorithms::compressFileWithLZW(const std::string &inputFileName, const std::string &outputFileName)
+bool CompressionAlgorithms::compressFileWithLZW(const std::string &inputFileName, const std::string &outputFileName,
+        const LZWOptions &options)
 {
-    return compressFile(inputFileName, outputFileName, &CompressionAlgorithms::compressWithLZW);
+    return compressFile(inputFileName, outputFileName, [&options](const ByteView &data) {
+        return compressWithLZW(data, options);
+    });
 }
 
 bool CompressionAlgorithms::decompressFileWithLZW(const std::string &inputFileName, const std::string &outputFileName)
 {
     return decompressFile(inputFileName, outputFileName, &CompressionAlgorithms::decompressWithLZW);
 }
+
+bool CompressionAlgorithms::compressFileWithRANS(const std::string &inputFileName, const std::string &outputFileName,
+        size_t blockSize)
+{
+    return compressFile(inputFileName, outputFileName, [blockSize](const ByteView &data) {
+        return compressWithRANS(data, blockSize);
+    });
+}
+
+bool CompressionAlgorithms::decompressFileWithRANS(const std::string &inputFileName, const std::string &outputFileName)
+{
+    return decompressFile(inputFileName, outputFileName, &CompressionAlgorithms::decompressWithRANS);
+}
+
+bool CompressionAlgorithms::compressFileWithCM(const std::string &inputFileName, const std::string &outputFileName)
+{
+    return compressFile(inputFileName, outputFileName, &CompressionAlgorithms::compressWithCM);
+}
+
+bool CompressionAlgorithms::decompressFileWithCM(const std::string &inputFileName, const std::string &outputFileName)
+{
+    return decompressFile(inputFileName, outputFileName, &CompressionAlgorithms::decompressWithCM);
+}
@@ -12,43 +12,150 @@
 #include <vector>
 #include <string>
 #include <functional>
+#include <memory>
+
+#include "byteview.h"
+
+struct LZMA2Options {
+    enum Check {
+        CheckNone,
+        CheckCRC32,
+        CheckCRC64,
+        CheckSHA256
+    };
+
+    uint32_t preset = 6;
+    bool extreme = false;
+    // Zero keeps the dictionary size of the preset
+    uint32_t dictionarySize = 0;
+    Check check = CheckCRC64;
+
+    // More than one thread switches to the multi-threaded .xz encoder and
+    // decoder, zero uses every hardware thread
+    uint32_t threadCount = 1;
+    // Zero lets liblzma pick three times the dictionary size
+    uint64_t blockSize = 0;
+    // Zero means no limit. Otherwise threads are dropped to stay below it and
+    // decoding fails when a single thread would need more.
+    uint64_t memoryLimit = 0;
+};
+
+struct LZ77Options {
+    enum Parsing {
+        ParsingGreedy,
+        ParsingLazy,
+        // Minimizes the token count over the longest match of every position
+        ParsingOptimal
+    };
+
+    // Greedy parsing takes the longest match at every position. Lazy parsing
+    // also looks one position ahead and optimal parsing plans the whole
+    // token sequence, both give fewer tokens for more time per byte.
+    Parsing parsing = ParsingGreedy;
+    // Hash chain entries compared per position, the window size makes the
+    // search exhaustive
+    uint32_t searchDepth = 256;
+};
+
+struct LZSSOptions {
+    // The window holds 2^windowBits bytes, between 2^10 and 2^24
+    uint32_t windowBits = 20;
+    uint32_t searchDepth = 64;
+    // Emits a literal when the next position has a longer match
+    bool lazy = true;
+};
+
+// Used by both LZW and LZ78
+struct LZWOptions {
+    // Codes grow from 9 bits up to maxBits, between 9 and 20
+    uint32_t maxBits = 16;
+    // Clears a full dictionary when the ratio gets worse
+    bool adaptiveReset = true;
+};
 
 class CompressionAlgorithms
 {
 public:
+    // rANS codes each block with its own frequency table
+    static const size_t DefaultRANSBlockSize = 1024 * 1024;
+
     CompressionAlgorithms();
     ~CompressionAlgorithms();
 
-    bool compressFileWithLZMA2(const std::string &inputFileName, const std::string &outputFileName);
-    bool decompressFileWithLZMA2(const std::string &inputFileName, const std::string &outputFileName);
+    bool compressFileWithLZMA2(const std::string &inputFileName, const std::string &outputFileName,
+                               const LZMA2Options &options = LZMA2Options());
+    bool decompressFileWithLZMA2(const std::string &inputFileName, const std::string &outputFileName,
+                                 const LZMA2Options &options = LZMA2Options());
 
-    bool compressFileWithLZ77(const std::string &inputFileName, const std::string &outputFileName);
+    bool compressFileWithLZ77(const std::string &inputFileName, const std::string &outputFileName,
+                              const LZ77Options &options = LZ77Options());
     bool decompressFileWithLZ77(const std::string &inputFileName, const std::string &outputFileName);
 
-    bool compressFileWithLZ78(const std::string &inputFileName, const std::string &outputFileName);
+    bool compressFileWithLZSS(const std::string &inputFileName, const std::string &outputFileName,
+                              const LZSSOptions &options = LZSSOptions());
+    bool decompressFileWithLZSS(const std::string &inputFileName, const std::string &outputFileName);
+
+    bool compressFileWithLZ78(const std::string &inputFileName, const std::string &outputFileName,
+                              const LZWOptions &options = LZWOptions());
     bool decompressFileWithLZ78(const std::string &inputFileName, const std::string &outputFileName);
 
-    bool compressFileWithLZW(const std::string &inputFileName, const std::string &outputFileName);
+    bool compressFileWithLZW(const std::string &inputFileName, const std::string &outputFileName,
+                             const LZWOptions &options = LZWOptions());
     bool decompressFileWithLZW(const std::string &inputFileName, const std::string &outputFileName);
 
+    bool compressFileWithRANS(const std::string &inputFileName, const std::string &outputFileName,
+                              size_t blockSize = DefaultRANSBlockSize);
+    bool decompressFileWithRANS(const std::string &inputFileName, const std::string &outputFileName);
+
+    bool compressFileWithCM(const std::string &inputFileName, const std::string &outputFileName);
+    bool decompressFileWithCM(const std::string &inputFileName, const std::string &outputFileName);
+
 protected:
-    static std::vector<uint8_t> compressWithLZMA2(const std::vector<uint8_t> &data);
-    static std::vector<uint8_t> decompressWithLZMA2(const std::vector<uint8_t> &compressedData);
+    // Codes an .xz stream chunk by chunk, the output does not depend on how
+    // the input is split. The last call may pass an empty chunk.
+    class LZMA2ChunkCoder
+    {
+    public:
+        LZMA2ChunkCoder(bool encoder, const LZMA2Options &options = LZMA2Options());
+        ~LZMA2ChunkCoder();
+
+        LZMA2ChunkCoder(const LZMA2ChunkCoder &) = delete;
+        LZMA2ChunkCoder &operator=(const LZMA2ChunkCoder &) = delete;
+
+        void code(std::vector<uint8_t> &chunk, bool last);
+
+    private:
+        struct Stream;
+        std::unique_ptr<Stream> m_stream;
+    };
+
+    static std::vector<uint8_t> compressWithLZMA2(const ByteView &data, const LZMA2Options &options = LZMA2Options());
+    static std::vector<uint8_t> decompressWithLZMA2(const ByteView &compressedData,
+            const LZMA2Options &options = LZMA2Options());
+
+    static std::vector<uint8_t> compressWithLZ77(const ByteView &data, const LZ77Options &options = LZ77Options());
+    static std::vector<uint8_t> decompressWithLZ77(const ByteView &compressedData);
+
+    static std::vector<uint8_t> compressWithLZSS(const ByteView &data, const LZSSOptions &options = LZSSOptions());
+    static std::vector<uint8_t> decompressWithLZSS(const ByteView &compressedData);
+
+    static std::vector<uint8_t> compressWithLZ78(const ByteView &data, const LZWOptions &options = LZWOptions());
+    static std::vector<uint8_t> decompressWithLZ78(const ByteView &compressedData);
 
-    static std::vector<uint8_t> compressWithLZ77(const std::vector<uint8_t> &data);
-    static std::vector<uint8_t> decompressWithLZ77(const std::vector<uint8_t> &compressedData);
+    static std::vector<uint8_t> compressWithLZW(const ByteView &data, const LZWOptions &options = LZWOptions());
+    static std::vector<uint8_t> decompressWithLZW(const ByteView &compressedData);
 
-    static std::vector<uint8_t> compressWithLZ78(const std::vector<uint8_t> &data);
-    static std::vector<uint8_t> decompressWithLZ78(const std::vector<uint8_t> &compressedData);
+    static std::vector<uint8_t> compressWithRANS(const ByteView &data, size_t blockSize = DefaultRANSBlockSize);
+    static std::vector<uint8_t> decompressWithRANS(const ByteView &compressedData);
 
-    static std::vector<uint8_t> compressWithLZW(const std::vector<uint8_t> &data);
-    static std::vector<uint8_t> decompressWithLZW(const std::vector<uint8_t> &compressedData);
+    static std::vector<uint8_t> compressWithCM(const ByteView &data);
+    static std::vector<uint8_t> decompressWithCM(const ByteView &compressedData);
 
 private:
     bool compressFile(const std::string &inputFileName, const std::string &outputFileName,
-                      std::function<std::vector<uint8_t>(const std::vector<uint8_t> &)> compressAlgorithm);
+                      std::function<std::vector<uint8_t>(const ByteView &)> compressAlgorithm);
     bool decompressFile(const std::string &inputFileName, const std::string &outputFileName,
-                        std::function<std::vector<uint8_t>(const std::vector<uint8_t> &)> decompressAlgorithm);
+                        std::function<std::vector<uint8_t>(const ByteView &)> decompressAlgorithm);
 };
 
 #endif // COMPRESSIONALGORITHMS_H
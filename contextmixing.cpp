@@ -0,0 +1,340 @@
+/******************************************************************************
+ * File Name    : contextmixing.cpp
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Order-0/1/2 Context Mixing Binary Arithmetic Coder
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#include "contextmixing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+static const unsigned ModelCount = 3;
+// The mixer also takes a constant bias input
+static const unsigned InputCount = ModelCount + 1;
+// Counters of one nibble share a 64 byte group, so a byte touches two cache
+// lines per model
+static const unsigned GroupSize = 16;
+static const unsigned Order2GroupBits = 18;
+static const uint32_t CounterLimit = 127;
+static const int WeightOne = 1 << 16;
+static const int LearningShift = 10;
+static const int MaxStretch = 2047;
+// A counter packs a 22 bit probability and a 10 bit hit count
+static const uint32_t CounterCountMask = 1023;
+static const uint32_t InitialCounter = 1u << 31;
+
+class LogisticTables
+{
+public:
+    LogisticTables()
+    {
+        for (int i = 0; i < 4096; ++i) {
+            m_squash[i] = static_cast<int16_t>(std::lround(4096.0 / (1.0 + std::exp((2048 - i) / 256.0))));
+            m_squash[i] = std::min<int16_t>(4095, std::max<int16_t>(1, m_squash[i]));
+        }
+
+        // Inverse of squash, rounded towards the middle
+        int pi = 0;
+
+        for (int x = -MaxStretch; x <= MaxStretch; ++x) {
+            int v = squash(x);
+
+            for (int p = pi; p <= v; ++p) {
+                m_stretch[p] = static_cast<int16_t>(x);
+            }
+
+            pi = v + 1;
+        }
+
+        for (int p = pi; p < 4096; ++p) {
+            m_stretch[p] = MaxStretch;
+        }
+    }
+
+    // Maps x = 256 * ln(p / (1 - p)) back to a 12 bit probability p
+    int squash(int x) const
+    {
+        return m_squash[std::min(MaxStretch, std::max(-MaxStretch, x)) + 2048];
+    }
+
+    int stretch(int p) const
+    {
+        return m_stretch[p];
+    }
+
+private:
+    int16_t m_squash[4096];
+    int16_t m_stretch[4096];
+};
+
+static const LogisticTables &logisticTables()
+{
+    static const LogisticTables tables;
+    return tables;
+}
+
+// Counter storage whose groups start on cache line boundaries
+class CounterTable
+{
+public:
+    explicit CounterTable(size_t groupCount) : m_storage(groupCount * GroupSize + GroupSize, InitialCounter)
+    {
+        uintptr_t address = reinterpret_cast<uintptr_t>(m_storage.data());
+        m_counters = m_storage.data() + ((64 - address % 64) % 64) / sizeof(uint32_t);
+    }
+
+    uint32_t *group(size_t index)
+    {
+        return m_counters + index * GroupSize;
+    }
+
+private:
+    std::vector<uint32_t> m_storage;
+    uint32_t *m_counters;
+};
+
+class ContextModel
+{
+public:
+    ContextModel() : m_tables(logisticTables()), m_order0(GroupSize + 1), m_order1(256 * (GroupSize + 1)),
+        m_order2(size_t(1) << Order2GroupBits), m_weights(256 * InputCount, WeightOne / 3), m_partial(1),
+        m_nibble(1), m_history(0), m_probability(2048)
+    {
+        selectGroups();
+    }
+
+    // Probability of a one bit, in 12 bits
+    int predict()
+    {
+        m_counters[0] = m_groups[0] + m_nibble;
+        m_counters[1] = m_groups[1] + m_nibble;
+        m_counters[2] = m_groups[2] + m_nibble;
+
+        const int32_t *weights = &m_weights[m_partial * InputCount];
+        int64_t dot = 0;
+
+        for (unsigned i = 0; i < ModelCount; ++i) {
+            m_inputs[i] = m_tables.stretch(*m_counters[i] >> 20);
+            dot += static_cast<int64_t>(m_inputs[i]) * weights[i];
+        }
+
+        m_inputs[ModelCount] = 256;
+        dot += static_cast<int64_t>(m_inputs[ModelCount]) * weights[ModelCount];
+
+        m_probability = m_tables.squash(static_cast<int>(dot >> 16));
+        return m_probability;
+    }
+
+    void update(int bit)
+    {
+        int32_t *weights = &m_weights[m_partial * InputCount];
+        int error = (bit << 12) - m_probability;
+
+        for (unsigned i = 0; i < InputCount; ++i) {
+            weights[i] += (m_inputs[i] * error) >> LearningShift;
+        }
+
+        for (unsigned i = 0; i < ModelCount; ++i) {
+            updateCounter(*m_counters[i], bit);
+        }
+
+        m_partial = (m_partial << 1) | bit;
+        m_nibble = (m_nibble << 1) | bit;
+
+        if (m_nibble >= GroupSize) {
+            m_nibble = 1;
+
+            if (m_partial >= 256) {
+                m_history = (m_history << 8) | (m_partial & 0xFF);
+                m_partial = 1;
+            }
+
+            selectGroups();
+        }
+    }
+
+private:
+    // Adapts fast while the count is low, then at 1 / CounterLimit
+    static void updateCounter(uint32_t &counter, int bit)
+    {
+        static const struct Rates {
+            Rates()
+            {
+                for (uint32_t i = 0; i <= CounterCountMask; ++i) {
+                    value[i] = static_cast<int>(16384 / (i + i + 3));
+                }
+            }
+
+            int value[CounterCountMask + 1];
+        } rates;
+
+        uint32_t count = counter & CounterCountMask;
+        int probability = static_cast<int>(counter >> 10);
+
+        if (count < CounterLimit) {
+            counter++;
+        }
+
+        int64_t delta = static_cast<int64_t>(((bit << 22) - probability) >> 3) * rates.value[count];
+        counter += static_cast<uint32_t>(delta) & ~CounterCountMask;
+    }
+
+    // The second nibble of a byte gets its own groups, keyed by the first
+    void selectGroups()
+    {
+        uint32_t nibbleContext = (m_partial == 1) ? 0 : (m_partial & 0xF) + 1;
+        uint32_t c1 = m_history & 0xFF;
+        uint32_t c2 = m_history & 0xFFFF;
+
+        m_groups[0] = m_order0.group(nibbleContext);
+        m_groups[1] = m_order1.group(c1 * (GroupSize + 1) + nibbleContext);
+
+        uint32_t hash = (c2 * 0x9E3779B1u) ^ (nibbleContext * 0x85EBCA6Bu);
+        m_groups[2] = m_order2.group((hash ^ (hash >> 15)) & ((1u << Order2GroupBits) - 1));
+    }
+
+    const LogisticTables &m_tables;
+    CounterTable m_order0;
+    CounterTable m_order1;
+    CounterTable m_order2;
+    // One weight set per partial byte, each set fits in 16 bytes
+    std::vector<int32_t> m_weights;
+
+    uint32_t *m_groups[ModelCount];
+    uint32_t *m_counters[ModelCount];
+    int m_inputs[InputCount];
+
+    uint32_t m_partial;
+    uint32_t m_nibble;
+    uint32_t m_history;
+    int m_probability;
+};
+
+// Carryless binary arithmetic coder over 32 bit bounds
+class ArithmeticEncoder
+{
+public:
+    explicit ArithmeticEncoder(std::vector<uint8_t> &output) : m_output(output), m_low(0), m_high(UINT32_MAX) {}
+
+    void encode(int bit, int probability)
+    {
+        uint32_t middle = m_low + static_cast<uint32_t>((static_cast<uint64_t>(m_high - m_low) * probability) >> 12);
+
+        if (bit) {
+            m_high = middle;
+        } else {
+            m_low = middle + 1;
+        }
+
+        while (((m_low ^ m_high) & 0xFF000000) == 0) {
+            m_output.push_back(static_cast<uint8_t>(m_high >> 24));
+            m_low <<= 8;
+            m_high = (m_high << 8) | 0xFF;
+        }
+    }
+
+    void flush()
+    {
+        for (unsigned i = 0; i < 4; ++i) {
+            m_output.push_back(static_cast<uint8_t>(m_low >> (24 - i * 8)));
+        }
+    }
+
+private:
+    std::vector<uint8_t> &m_output;
+    uint32_t m_low;
+    uint32_t m_high;
+};
+
+class ArithmeticDecoder
+{
+public:
+    explicit ArithmeticDecoder(const ByteView &input) : m_data(input.data()), m_size(input.size()), m_pos(0), m_low(0),
+        m_high(UINT32_MAX), m_code(0)
+    {
+        for (unsigned i = 0; i < 4; ++i) {
+            m_code = (m_code << 8) | nextByte();
+        }
+    }
+
+    int decode(int probability)
+    {
+        uint32_t middle = m_low + static_cast<uint32_t>((static_cast<uint64_t>(m_high - m_low) * probability) >> 12);
+        int bit = m_code <= middle;
+
+        if (bit) {
+            m_high = middle;
+        } else {
+            m_low = middle + 1;
+        }
+
+        while (((m_low ^ m_high) & 0xFF000000) == 0) {
+            m_low <<= 8;
+            m_high = (m_high << 8) | 0xFF;
+            m_code = (m_code << 8) | nextByte();
+        }
+
+        return bit;
+    }
+
+private:
+    // The encoder flushes its whole state, so a valid stream is never read
+    // past its end
+    uint8_t nextByte()
+    {
+        if (m_pos >= m_size) {
+            throw std::runtime_error("Context mixing stream is truncated!");
+        }
+
+        return m_data[m_pos++];
+    }
+
+    const uint8_t *m_data;
+    size_t m_size;
+    size_t m_pos;
+    uint32_t m_low;
+    uint32_t m_high;
+    uint32_t m_code;
+};
+
+void ContextMixingCoder::encode(const uint8_t *data, size_t size, std::vector<uint8_t> &output)
+{
+    ContextModel model;
+    ArithmeticEncoder encoder(output);
+
+    for (size_t i = 0; i < size; ++i) {
+        for (int shift = 7; shift >= 0; --shift) {
+            int bit = (data[i] >> shift) & 1;
+            encoder.encode(bit, model.predict());
+            model.update(bit);
+        }
+    }
+
+    encoder.flush();
+}
+
+void ContextMixingCoder::decode(const ByteView &input, size_t size, std::vector<uint8_t> &output)
+{
+    ContextModel model;
+    ArithmeticDecoder decoder(input);
+
+    // A bit costs at least 1/4096 of its probability range, which bounds
+    // the size a corrupted header can make us reserve
+    output.reserve(output.size() + std::min<uint64_t>(size, static_cast<uint64_t>(input.size()) * 4096));
+
+    for (size_t i = 0; i < size; ++i) {
+        int byte = 0;
+
+        for (int k = 0; k < 8; ++k) {
+            int bit = decoder.decode(model.predict());
+            model.update(bit);
+            byte = (byte << 1) | bit;
+        }
+
+        output.push_back(static_cast<uint8_t>(byte));
+    }
+}
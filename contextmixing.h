@@ -0,0 +1,31 @@
+/******************************************************************************
+ * File Name    : contextmixing.h
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Order-0/1/2 Context Mixing Binary Arithmetic Coder
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#ifndef CONTEXTMIXING_H
+#define CONTEXTMIXING_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "byteview.h"
+
+class ContextMixingCoder
+{
+public:
+    // Bytes are coded most significant bit first. Every bit is predicted by
+    // adaptive order-0, order-1 and hashed order-2 models whose stretched
+    // probabilities are mixed by weights selected by the bits seen so far
+    // in the current byte.
+    static void encode(const uint8_t *data, size_t size, std::vector<uint8_t> &output);
+
+    // Appends size decoded bytes to output. Throws when the input ends first.
+    static void decode(const ByteView &input, size_t size, std::vector<uint8_t> &output);
+};
+
+#endif // CONTEXTMIXING_H
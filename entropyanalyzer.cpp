@@ -0,0 +1,439 @@
+/******************************************************************************
+ * File Name    : entropyanalyzer.cpp
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Streaming Entropy And Byte Statistics Of Data
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#include "entropyanalyzer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+const size_t EntropyReport::MaxStride;
+const size_t EntropyReport::RunBuckets;
+const size_t EntropyAnalyzer::BlockSize;
+
+static const size_t HistogramBanks = 4;
+// 65536 products of two bytes still fit 32 bits
+static const size_t ProductSpan = 65536;
+
+struct EntropyAnalyzer::BlockStats {
+    BlockStats() : pairs(256 * 256) {}
+
+    uint32_t histogram[HistogramBanks][256];
+    std::vector<uint32_t> pairs;
+    uint64_t strideProducts[EntropyReport::MaxStride];
+    // Runs which neither start nor end the block
+    uint64_t runs[EntropyReport::RunBuckets];
+    uint8_t first;
+    uint8_t last;
+    uint64_t leadingRun;
+    uint64_t trailingRun;
+    bool uniform;
+};
+
+static size_t runBucket(uint64_t length)
+{
+    return 63 - __builtin_clzll(length);
+}
+
+EntropyReport::EntropyReport() : size(0), histogram(256), pairs(256 * 256), runs(RunBuckets),
+    strideProducts(MaxStride)
+{
+}
+
+double EntropyReport::order0Entropy() const
+{
+    double entropy = 0;
+
+    for (uint64_t count : histogram) {
+        if (count) {
+            double probability = static_cast<double>(count) / size;
+            entropy -= probability * std::log2(probability);
+        }
+    }
+
+    return entropy;
+}
+
+double EntropyReport::order1Entropy() const
+{
+    uint64_t pairCount = 0;
+    double entropy = 0;
+
+    for (size_t previous = 0; previous < 256; ++previous) {
+        const uint64_t *row = &pairs[previous << 8];
+        uint64_t rowCount = 0;
+
+        for (size_t byte = 0; byte < 256; ++byte) {
+            rowCount += row[byte];
+        }
+
+        for (size_t byte = 0; byte < 256; ++byte) {
+            if (row[byte]) {
+                entropy -= row[byte] * std::log2(static_cast<double>(row[byte]) / rowCount);
+            }
+        }
+
+        pairCount += rowCount;
+    }
+
+    return pairCount ? entropy / pairCount : 0;
+}
+
+uint64_t EntropyReport::order0Size() const
+{
+    return static_cast<uint64_t>(std::ceil(order0Entropy() * size / 8));
+}
+
+size_t EntropyReport::distinctBytes() const
+{
+    return histogram.size() - std::count(histogram.begin(), histogram.end(), 0);
+}
+
+size_t EntropyReport::distinctPairs() const
+{
+    return pairs.size() - std::count(pairs.begin(), pairs.end(), 0);
+}
+
+double EntropyReport::autocorrelation(size_t stride) const
+{
+    if (stride == 0 || stride > MaxStride || size <= stride) {
+        return 0;
+    }
+
+    double sum = 0;
+    double squares = 0;
+
+    for (size_t byte = 0; byte < 256; ++byte) {
+        sum += static_cast<double>(byte) * histogram[byte];
+        squares += static_cast<double>(byte * byte) * histogram[byte];
+    }
+
+    double mean = sum / size;
+    double variance = squares / size - mean * mean;
+
+    if (variance <= 0) {
+        return 0;
+    }
+
+    return (static_cast<double>(strideProducts[stride - 1]) / (size - stride) - mean * mean) / variance;
+}
+
+EntropyAnalyzer::EntropyAnalyzer(ThreadPool *pool) : m_pool(pool), m_contextSize(0),
+    m_batchSize(BlockSize * (pool ? pool->threadCount() : 1)), m_blocks(pool ? pool->threadCount() : 1),
+    m_runByte(0), m_runLength(0)
+{
+    m_batch.reserve(EntropyReport::MaxStride + m_batchSize);
+}
+
+EntropyAnalyzer::~EntropyAnalyzer()
+{
+}
+
+void EntropyAnalyzer::update(const ByteView &chunk)
+{
+    const uint8_t *data = chunk.data();
+    size_t remaining = chunk.size();
+
+    while (remaining > 0) {
+        size_t size = std::min(remaining, m_contextSize + m_batchSize - m_batch.size());
+        m_batch.insert(m_batch.end(), data, data + size);
+        data += size;
+        remaining -= size;
+
+        if (m_batch.size() == m_contextSize + m_batchSize) {
+            analyzeBatch();
+        }
+    }
+}
+
+EntropyReport EntropyAnalyzer::finish()
+{
+    analyzeBatch();
+    addRun(m_runLength);
+    m_runLength = 0;
+    return m_report;
+}
+
+EntropyReport EntropyAnalyzer::analyze(const ByteView &data, ThreadPool *pool)
+{
+    EntropyAnalyzer analyzer(pool);
+    analyzer.update(data);
+    return analyzer.finish();
+}
+
+void EntropyAnalyzer::writeReport(std::ostream &output, const std::string &name, const EntropyReport &report)
+{
+    output << name << "\n" << std::fixed << std::setprecision(4)
+           << "  size             " << report.size << "\n"
+           << "  order0 entropy   " << report.order0Entropy() << " bits/byte, "
+           << report.order0Size() << " bytes\n"
+           << "  order1 entropy   " << report.order1Entropy() << " bits/byte\n"
+           << "  distinct bytes   " << report.distinctBytes() << "\n"
+           << "  distinct pairs   " << report.distinctPairs() << "\n"
+           << "  runs             ";
+
+    for (size_t bucket = 0; bucket < EntropyReport::RunBuckets; ++bucket) {
+        if (report.runs[bucket]) {
+            output << (uint64_t(1) << bucket) << "+:" << report.runs[bucket] << " ";
+        }
+    }
+
+    output << "\n  autocorrelation  ";
+
+    for (size_t stride = 1; stride <= EntropyReport::MaxStride; ++stride) {
+        output << stride << ":" << std::setprecision(2) << report.autocorrelation(stride) << " ";
+    }
+
+    output << "\n" << std::defaultfloat << std::setprecision(6);
+}
+
+// Blocks are analyzed in parallel, then merged in stream order so runs
+// crossing a block border are joined
+void EntropyAnalyzer::analyzeBatch()
+{
+    size_t dataSize = m_batch.size() - m_contextSize;
+
+    if (dataSize == 0) {
+        return;
+    }
+
+    size_t blockCount = (dataSize + BlockSize - 1) / BlockSize;
+
+    auto analyzeBlockAt = [this, dataSize](size_t i) {
+        size_t offset = i * BlockSize;
+        analyzeBlock(m_batch.data() + m_contextSize + offset, std::min(BlockSize, dataSize - offset),
+                     std::min(EntropyReport::MaxStride, m_contextSize + offset), m_blocks[i]);
+    };
+
+    if (m_pool) {
+        m_pool->parallelFor(blockCount, analyzeBlockAt);
+    } else {
+        analyzeBlockAt(0);
+    }
+
+    for (size_t i = 0; i < blockCount; ++i) {
+        const BlockStats &block = m_blocks[i];
+
+        for (size_t byte = 0; byte < 256; ++byte) {
+            for (size_t bank = 0; bank < HistogramBanks; ++bank) {
+                m_report.histogram[byte] += block.histogram[bank][byte];
+            }
+        }
+
+        for (size_t pair = 0; pair < block.pairs.size(); ++pair) {
+            m_report.pairs[pair] += block.pairs[pair];
+        }
+
+        for (size_t stride = 0; stride < EntropyReport::MaxStride; ++stride) {
+            m_report.strideProducts[stride] += block.strideProducts[stride];
+        }
+
+        for (size_t bucket = 0; bucket < EntropyReport::RunBuckets; ++bucket) {
+            m_report.runs[bucket] += block.runs[bucket];
+        }
+
+        if (m_runLength > 0 && block.first == m_runByte) {
+            m_runLength += block.leadingRun;
+        } else {
+            addRun(m_runLength);
+            m_runByte = block.first;
+            m_runLength = block.leadingRun;
+        }
+
+        if (!block.uniform) {
+            addRun(m_runLength);
+            m_runByte = block.last;
+            m_runLength = block.trailingRun;
+        }
+    }
+
+    m_report.size += dataSize;
+
+    // Pairs and strides of the next batch look back into this one
+    size_t contextSize = std::min(EntropyReport::MaxStride, m_batch.size());
+    m_batch.erase(m_batch.begin(), m_batch.end() - contextSize);
+    m_contextSize = contextSize;
+}
+
+void EntropyAnalyzer::addRun(uint64_t length)
+{
+    if (length > 0) {
+        m_report.runs[runBucket(length)]++;
+    }
+}
+
+// Adds byte[i] * byte[i - stride] of every position which can look back
+// stride bytes into the block and its context
+static void addStrideProducts(const uint8_t *data, size_t size, size_t contextSize, uint64_t *products)
+{
+    const size_t maxStride = EntropyReport::MaxStride;
+    size_t i = std::min(size, maxStride - std::min(maxStride, contextSize));
+
+    std::fill(products, products + maxStride, 0);
+
+    for (size_t stride = 1; stride <= maxStride; ++stride) {
+        for (size_t j = stride - std::min(stride, contextSize); j < i; ++j) {
+            products[stride - 1] += static_cast<uint32_t>(data[j]) * data[j - stride];
+        }
+    }
+
+#if defined(__SSE2__)
+    // Four strides share each load of 16 bytes. A 32 bit lane sums four
+    // products per load, so it does not overflow within a span.
+    static_assert(EntropyReport::MaxStride % 4 == 0, "Strides are multiplied four at a time");
+    size_t vectorEnd = i + (size - i) / 16 * 16;
+    __m128i zero = _mm_setzero_si128();
+
+    for (size_t stride = 1; stride <= maxStride; stride += 4) {
+        for (size_t begin = i; begin < vectorEnd; begin += ProductSpan) {
+            size_t end = std::min(vectorEnd, begin + ProductSpan);
+            __m128i sums[4] = { zero, zero, zero, zero };
+
+            for (size_t j = begin; j < end; j += 16) {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + j));
+                __m128i low = _mm_unpacklo_epi8(bytes, zero);
+                __m128i high = _mm_unpackhi_epi8(bytes, zero);
+
+                for (size_t k = 0; k < 4; ++k) {
+                    __m128i before = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + j - stride - k));
+                    sums[k] = _mm_add_epi32(sums[k], _mm_madd_epi16(low, _mm_unpacklo_epi8(before, zero)));
+                    sums[k] = _mm_add_epi32(sums[k], _mm_madd_epi16(high, _mm_unpackhi_epi8(before, zero)));
+                }
+            }
+
+            for (size_t k = 0; k < 4; ++k) {
+                uint32_t lanes[4];
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), sums[k]);
+                products[stride - 1 + k] += uint64_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+            }
+        }
+    }
+
+    i = vectorEnd;
+#endif
+
+    // Sums in 32 bits over short spans let the compiler vectorize the rest
+    for (size_t stride = 1; stride <= maxStride; ++stride) {
+        for (size_t begin = i; begin < size; begin += ProductSpan) {
+            size_t end = std::min(size, begin + ProductSpan);
+            uint32_t sum = 0;
+
+            for (size_t j = begin; j < end; ++j) {
+                sum += static_cast<uint32_t>(data[j]) * data[j - stride];
+            }
+
+            products[stride - 1] += sum;
+        }
+    }
+}
+
+// The contextSize bytes before data belong to the stream and are only
+// looked back at
+void EntropyAnalyzer::analyzeBlock(const uint8_t *data, size_t size, size_t contextSize, BlockStats &stats)
+{
+    std::memset(stats.histogram, 0, sizeof(stats.histogram));
+    std::memset(stats.runs, 0, sizeof(stats.runs));
+    std::fill(stats.pairs.begin(), stats.pairs.end(), 0);
+
+    // Equal bytes next to each other count into different banks, so their
+    // increments do not wait on each other
+    size_t i = 0;
+
+    for (; i + HistogramBanks <= size; i += HistogramBanks) {
+        stats.histogram[0][data[i]]++;
+        stats.histogram[1][data[i + 1]]++;
+        stats.histogram[2][data[i + 2]]++;
+        stats.histogram[3][data[i + 3]]++;
+    }
+
+    for (; i < size; ++i) {
+        stats.histogram[0][data[i]]++;
+    }
+
+    uint32_t *pairs = stats.pairs.data();
+
+    for (i = (contextSize > 0) ? 0 : 1; i < size; ++i) {
+        pairs[static_cast<size_t>(data[i - 1]) << 8 | data[i]]++;
+    }
+
+    addStrideProducts(data, size, contextSize, stats.strideProducts);
+
+    stats.first = data[0];
+    stats.last = data[size - 1];
+    stats.leadingRun = 1;
+
+    while (stats.leadingRun < size && data[stats.leadingRun] == data[0]) {
+        stats.leadingRun++;
+    }
+
+    stats.uniform = (stats.leadingRun == size);
+    stats.trailingRun = stats.leadingRun;
+
+    if (stats.uniform) {
+        return;
+    }
+
+    stats.trailingRun = 1;
+
+    while (data[size - 1 - stats.trailingRun] == stats.last) {
+        stats.trailingRun++;
+    }
+
+    // A byte which differs from the next one ends a run. data[end] starts
+    // the trailing run, so it differs from data[end - 1].
+    size_t end = size - stats.trailingRun;
+    size_t lastEnd = stats.leadingRun - 1;
+    i = stats.leadingRun;
+
+#if defined(__SSE2__)
+    // Run ends are found 64 bytes at a time. Runs of one byte end next to
+    // the previous end, they are counted together and only longer runs are
+    // visited one by one.
+    for (; i + 64 <= end; i += 64) {
+        uint64_t mask = 0;
+
+        for (size_t k = 0; k < 64; k += 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + k));
+            __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + k + 1));
+            mask |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, next)))) << k;
+        }
+
+        mask = ~mask;
+
+        if (!mask) {
+            continue;
+        }
+
+        uint64_t singles = mask & ((mask << 1) | (lastEnd == i - 1));
+        uint64_t longer = mask & ~singles;
+        stats.runs[0] += __builtin_popcountll(singles);
+
+        while (longer) {
+            unsigned bit = __builtin_ctzll(longer);
+            uint64_t before = mask & ((uint64_t(1) << bit) - 1);
+            size_t previousEnd = before ? i + 63 - __builtin_clzll(before) : lastEnd;
+            stats.runs[runBucket(i + bit - previousEnd)]++;
+            longer &= longer - 1;
+        }
+
+        lastEnd = i + 63 - __builtin_clzll(mask);
+    }
+#endif
+
+    for (; i < end; ++i) {
+        if (data[i] != data[i + 1]) {
+            stats.runs[runBucket(i - lastEnd)]++;
+            lastEnd = i;
+        }
+    }
+}
@@ -0,0 +1,89 @@
+/******************************************************************************
+ * File Name    : entropyanalyzer.h
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Streaming Entropy And Byte Statistics Of Data
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#ifndef ENTROPYANALYZER_H
+#define ENTROPYANALYZER_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+
+#include "byteview.h"
+#include "threadpool.h"
+
+struct EntropyReport {
+    static const size_t MaxStride = 16;
+    static const size_t RunBuckets = 64;
+
+    EntropyReport();
+
+    uint64_t size;
+    std::vector<uint64_t> histogram;
+    // Counts of each byte after each byte, indexed by previous << 8 | byte
+    std::vector<uint64_t> pairs;
+    // runs[k] counts the runs of equal bytes with a length in [2^k, 2^(k+1))
+    std::vector<uint64_t> runs;
+    // Sums of byte[i] * byte[i - stride] for strides 1 to MaxStride
+    std::vector<uint64_t> strideProducts;
+
+    // Shannon entropy in bits per byte, order one is conditioned on the
+    // previous byte
+    double order0Entropy() const;
+    double order1Entropy() const;
+    // Size an ideal order zero coder would give, in bytes
+    uint64_t order0Size() const;
+    size_t distinctBytes() const;
+    size_t distinctPairs() const;
+    // Correlation of the bytes with the bytes stride positions before
+    double autocorrelation(size_t stride) const;
+};
+
+// Takes a stream in chunks of any size and analyzes it in blocks, the
+// blocks of a batch in parallel. Memory stays at one batch however long
+// the stream is.
+class EntropyAnalyzer
+{
+public:
+    static const size_t BlockSize = 1024 * 1024;
+
+    // The pool may be shared by several analyzers on different threads.
+    // Without a pool the blocks are analyzed on the calling thread.
+    explicit EntropyAnalyzer(ThreadPool *pool = nullptr);
+    ~EntropyAnalyzer();
+
+    EntropyAnalyzer(const EntropyAnalyzer &) = delete;
+    EntropyAnalyzer &operator=(const EntropyAnalyzer &) = delete;
+
+    void update(const ByteView &chunk);
+    // Analyzes the buffered rest and returns the report of the stream
+    EntropyReport finish();
+
+    static EntropyReport analyze(const ByteView &data, ThreadPool *pool = nullptr);
+    static void writeReport(std::ostream &output, const std::string &name, const EntropyReport &report);
+
+private:
+    struct BlockStats;
+
+    void analyzeBatch();
+    void addRun(uint64_t length);
+    static void analyzeBlock(const uint8_t *data, size_t size, size_t contextSize, BlockStats &stats);
+
+    ThreadPool *m_pool;
+    // The last MaxStride bytes of the previous batch come first
+    std::vector<uint8_t> m_batch;
+    size_t m_contextSize;
+    size_t m_batchSize;
+    std::vector<BlockStats> m_blocks;
+    EntropyReport m_report;
+    // The run which is open at the end of the analyzed bytes
+    uint8_t m_runByte;
+    uint64_t m_runLength;
+};
+
+#endif // ENTROPYANALYZER_H
@@ -0,0 +1,381 @@
+/******************************************************************************
+ * File Name    : fileio.cpp
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Chunked File Input/Output
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#include "fileio.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <cstdio>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+// Returns false for pipes and other inputs without a known size
+static bool regularFileSize(int descriptor, uint64_t &size)
+{
+    struct stat status = {};
+
+    if (::fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode)) {
+        return false;
+    }
+
+    size = static_cast<uint64_t>(status.st_size);
+    return true;
+}
+
+static size_t readDescriptor(int descriptor, uint8_t *buffer, size_t capacity)
+{
+    size_t total = 0;
+
+    while (total < capacity) {
+        ssize_t count = ::read(descriptor, buffer + total, capacity - total);
+
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throw std::runtime_error("File could not be read!");
+        }
+
+        if (count == 0) {
+            break;
+        }
+
+        total += static_cast<size_t>(count);
+    }
+
+    return total;
+}
+
+// Outputs are written to a temporary file in the same directory which close
+// renames over the output. A failed run leaves no partial output behind and
+// an output may name the input. Devices and pipes are written directly.
+static int openOutput(const std::string &fileName, int flags, std::string &temporaryName)
+{
+    static std::atomic<unsigned> counter(0);
+    struct stat status = {};
+    temporaryName.clear();
+
+    if (::stat(fileName.c_str(), &status) == 0 && !S_ISREG(status.st_mode)) {
+        return ::open(fileName.c_str(), flags | O_CREAT | O_TRUNC, 0644);
+    }
+
+    for (;;) {
+        std::string name = fileName + ".tmp" + std::to_string(::getpid()) + "." + std::to_string(counter++);
+        int descriptor = ::open(name.c_str(), flags | O_CREAT | O_EXCL, 0644);
+
+        if (descriptor >= 0) {
+            temporaryName = name;
+        }
+
+        if (descriptor >= 0 || errno != EEXIST) {
+            return descriptor;
+        }
+    }
+}
+
+// Renames the temporary file over the output, or removes it when the
+// output was not completed
+static bool finishOutput(const std::string &fileName, std::string &temporaryName, bool completed)
+{
+    if (temporaryName.empty()) {
+        return true;
+    }
+
+    bool renamed = completed && std::rename(temporaryName.c_str(), fileName.c_str()) == 0;
+
+    if (!renamed) {
+        ::unlink(temporaryName.c_str());
+    }
+
+    temporaryName.clear();
+    return renamed || !completed;
+}
+
+FileReader::FileReader(const std::string &fileName) : m_descriptor(-1), m_size(0)
+{
+    m_descriptor = ::open(fileName.c_str(), O_RDONLY);
+
+    if (m_descriptor < 0) {
+        return;
+    }
+
+    regularFileSize(m_descriptor, m_size);
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    ::posix_fadvise(m_descriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+FileReader::~FileReader()
+{
+    if (m_descriptor >= 0) {
+        ::close(m_descriptor);
+    }
+}
+
+bool FileReader::isOpen() const
+{
+    return m_descriptor >= 0;
+}
+
+uint64_t FileReader::size() const
+{
+    return m_size;
+}
+
+size_t FileReader::read(uint8_t *buffer, size_t capacity)
+{
+    return readDescriptor(m_descriptor, buffer, capacity);
+}
+
+bool FileReader::readChunk(std::vector<uint8_t> &chunk, size_t chunkSize)
+{
+    chunk.resize(chunkSize);
+    chunk.resize(read(chunk.data(), chunkSize));
+    return !chunk.empty();
+}
+
+void FileReader::readAll(std::vector<uint8_t> &data)
+{
+    data.resize(static_cast<size_t>(m_size));
+    data.resize(read(data.data(), data.size()));
+
+    std::vector<uint8_t> chunk;
+
+    while (readChunk(chunk)) {
+        data.insert(data.end(), chunk.begin(), chunk.end());
+    }
+}
+
+FileWriter::FileWriter(const std::string &fileName) : m_descriptor(-1), m_fileName(fileName)
+{
+    m_descriptor = openOutput(fileName, O_WRONLY, m_temporaryName);
+}
+
+FileWriter::~FileWriter()
+{
+    if (m_descriptor >= 0) {
+        ::close(m_descriptor);
+    }
+
+    finishOutput(m_fileName, m_temporaryName, false);
+}
+
+bool FileWriter::isOpen() const
+{
+    return m_descriptor >= 0;
+}
+
+void FileWriter::write(const uint8_t *buffer, size_t size)
+{
+    while (size > 0) {
+        ssize_t count = ::write(m_descriptor, buffer, size);
+
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throw std::runtime_error("File could not be written!");
+        }
+
+        buffer += count;
+        size -= static_cast<size_t>(count);
+    }
+}
+
+void FileWriter::write(const std::vector<uint8_t> &data)
+{
+    write(data.data(), data.size());
+}
+
+void FileWriter::writeAt(uint64_t offset, const uint8_t *buffer, size_t size)
+{
+    while (size > 0) {
+        ssize_t count = ::pwrite(m_descriptor, buffer, size, static_cast<off_t>(offset));
+
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throw std::runtime_error("File could not be written!");
+        }
+
+        buffer += count;
+        offset += static_cast<uint64_t>(count);
+        size -= static_cast<size_t>(count);
+    }
+}
+
+void FileWriter::close()
+{
+    bool closed = m_descriptor < 0 || ::close(m_descriptor) == 0;
+    m_descriptor = -1;
+
+    if (!finishOutput(m_fileName, m_temporaryName, closed) || !closed) {
+        throw std::runtime_error("File could not be closed!");
+    }
+}
+
+MappedFile::MappedFile(const std::string &fileName) : m_descriptor(-1), m_data(nullptr), m_size(0),
+    m_mapped(false), m_open(false), m_fileName(fileName)
+{
+    m_descriptor = ::open(fileName.c_str(), O_RDONLY);
+
+    if (m_descriptor < 0) {
+        return;
+    }
+
+    m_open = true;
+
+    uint64_t fileSize = 0;
+
+    if (regularFileSize(m_descriptor, fileSize)) {
+        m_size = static_cast<size_t>(fileSize);
+
+        if (m_size == 0) {
+            return;
+        }
+
+        void *address = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_descriptor, 0);
+
+        if (address != MAP_FAILED) {
+            m_data = static_cast<uint8_t *>(address);
+            m_mapped = true;
+            return;
+        }
+    }
+
+    // Pipes and other unmappable inputs fall back to an owned copy, read
+    // through the open descriptor so a FIFO keeps its reader
+    try {
+        m_buffer.resize(m_size);
+        m_buffer.resize(readDescriptor(m_descriptor, m_buffer.data(), m_buffer.size()));
+
+        for (size_t count = 1; count > 0;) {
+            size_t offset = m_buffer.size();
+            m_buffer.resize(offset + FileReader::DefaultChunkSize);
+            count = readDescriptor(m_descriptor, m_buffer.data() + offset, FileReader::DefaultChunkSize);
+            m_buffer.resize(offset + count);
+        }
+    } catch (...) {
+        ::close(m_descriptor);
+        throw;
+    }
+
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+}
+
+MappedFile::MappedFile(const std::string &fileName, size_t size) : m_descriptor(-1), m_data(nullptr),
+    m_size(size), m_mapped(false), m_open(false), m_fileName(fileName)
+{
+    m_descriptor = openOutput(fileName, O_RDWR, m_temporaryName);
+
+    if (m_descriptor < 0) {
+        return;
+    }
+
+    if (size == 0) {
+        m_open = true;
+        return;
+    }
+
+    // Reserving the blocks up front turns a full disk into an error here
+    // instead of a SIGBUS while the mapping is being written
+    int error = ::posix_fallocate(m_descriptor, 0, static_cast<off_t>(size));
+
+    if (error != 0 && (error != EOPNOTSUPP && error != EINVAL)) {
+        ::close(m_descriptor);
+        m_descriptor = -1;
+        return;
+    }
+
+    if (error != 0 && ::ftruncate(m_descriptor, static_cast<off_t>(size)) != 0) {
+        ::close(m_descriptor);
+        m_descriptor = -1;
+        return;
+    }
+
+    void *address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_descriptor, 0);
+
+    if (address == MAP_FAILED) {
+        ::close(m_descriptor);
+        m_descriptor = -1;
+        return;
+    }
+
+    m_data = static_cast<uint8_t *>(address);
+    m_mapped = true;
+    m_open = true;
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_mapped) {
+        ::munmap(m_data, m_size);
+    }
+
+    if (m_descriptor >= 0) {
+        ::close(m_descriptor);
+    }
+
+    finishOutput(m_fileName, m_temporaryName, false);
+}
+
+bool MappedFile::isOpen() const
+{
+    return m_open;
+}
+
+size_t MappedFile::size() const
+{
+    return m_size;
+}
+
+const uint8_t *MappedFile::data() const
+{
+    return m_data;
+}
+
+uint8_t *MappedFile::data()
+{
+    return m_data;
+}
+
+ByteView MappedFile::view() const
+{
+    return ByteView(m_data, m_size);
+}
+
+void MappedFile::close()
+{
+    bool failed = false;
+
+    if (m_mapped) {
+        failed = ::munmap(m_data, m_size) != 0;
+        m_mapped = false;
+    }
+
+    if (m_descriptor >= 0) {
+        failed = ::close(m_descriptor) != 0 || failed;
+        m_descriptor = -1;
+    }
+
+    m_data = nullptr;
+    m_open = false;
+
+    if (!finishOutput(m_fileName, m_temporaryName, !failed) || failed) {
+        throw std::runtime_error("File could not be closed!");
+    }
+}
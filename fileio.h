@@ -0,0 +1,101 @@
+/******************************************************************************
+ * File Name    : fileio.h
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Chunked File Input/Output
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#ifndef FILEIO_H
+#define FILEIO_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "byteview.h"
+
+class FileReader
+{
+public:
+    static const size_t DefaultChunkSize = 1024 * 1024;
+
+    explicit FileReader(const std::string &fileName);
+    ~FileReader();
+
+    FileReader(const FileReader &) = delete;
+    FileReader &operator=(const FileReader &) = delete;
+
+    bool isOpen() const;
+    uint64_t size() const;
+
+    // Reads until the buffer is full or the file ends, returns the byte count
+    size_t read(uint8_t *buffer, size_t capacity);
+    // Replaces the chunk with the next chunkSize bytes, false at end of file
+    bool readChunk(std::vector<uint8_t> &chunk, size_t chunkSize = DefaultChunkSize);
+    void readAll(std::vector<uint8_t> &data);
+
+private:
+    int m_descriptor;
+    uint64_t m_size;
+};
+
+// The output only appears once close succeeds, until then it is written to
+// a temporary file in the same directory. An output may name the input.
+class FileWriter
+{
+public:
+    explicit FileWriter(const std::string &fileName);
+    ~FileWriter();
+
+    FileWriter(const FileWriter &) = delete;
+    FileWriter &operator=(const FileWriter &) = delete;
+
+    bool isOpen() const;
+
+    void write(const uint8_t *buffer, size_t size);
+    void write(const std::vector<uint8_t> &data);
+    void writeAt(uint64_t offset, const uint8_t *buffer, size_t size);
+    void close();
+
+private:
+    int m_descriptor;
+    std::string m_fileName;
+    std::string m_temporaryName;
+};
+
+// Maps a whole file into memory. The read-only form lets kernels work on the
+// page cache without a private copy, the writable form creates a file of a
+// known size that workers can fill in place. Like FileWriter, the writable
+// form only replaces the file once close succeeds.
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string &fileName);
+    MappedFile(const std::string &fileName, size_t size);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool isOpen() const;
+    size_t size() const;
+
+    const uint8_t *data() const;
+    uint8_t *data();
+    ByteView view() const;
+
+    void close();
+
+private:
+    int m_descriptor;
+    uint8_t *m_data;
+    size_t m_size;
+    bool m_mapped;
+    bool m_open;
+    std::vector<uint8_t> m_buffer;
+    std::string m_fileName;
+    std::string m_temporaryName;
+};
+
+#endif // FILEIO_H
@@ -0,0 +1,64 @@
+/******************************************************************************
+ * File Name    : fuzzdecoder.cpp
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : libFuzzer Entry Point For One Decoder
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#include "pipeline.h"
+
+#include <cstdlib>
+#include <exception>
+
+// Names a stage, or pipeline for the decoder of whole pipeline outputs
+#ifndef FUZZ_DECODER
+#error "FUZZ_DECODER must be defined"
+#endif
+
+class DecoderFuzzer : public Pipeline
+{
+public:
+    static void decode(const uint8_t *data, size_t size)
+    {
+        static const std::string name = FUZZ_DECODER;
+        ByteView input(data, size);
+
+        if (name == "pipeline") {
+            Pipeline::decode(input);
+            return;
+        }
+
+        StageSpec stage;
+
+        if (!stageFromName(name, stage)) {
+            std::abort();
+        }
+
+        // The stage decoder only takes the stride and order of its header,
+        // so the header of the input is used to reach the kernel
+        if (stage.stage == StageStrideDelta) {
+            getStrideDeltaHeader(input, stage.stride, stage.order);
+        }
+
+        if (isCompressionStage(stage.stage)) {
+            decompressStage(stage.stage, input);
+            return;
+        }
+
+        std::vector<uint8_t> buffer(input.begin(), input.end());
+        decodeStage(stage, buffer);
+    }
+};
+
+// Rejecting the input with an exception is fine, anything libFuzzer or the
+// sanitizers catch otherwise is a bug
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    try {
+        DecoderFuzzer::decode(data, size);
+    } catch (const std::exception &e) {
+    }
+
+    return 0;
+}
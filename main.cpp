@@ -1,39 +1,121 @@
 #include <iostream>
+#include <string>
+#include <vector>
 
-#include "compressionalgorithms.h"
-#include "transformationalgorithms.h"
+#include "pipeline.h"
 
-int main()
+static void printUsage(const char *program)
 {
-    CompressionAlgorithms compAlgo;
-    TransformationAlgorithms transAlgo;
+    std::cerr << "Usage:\n"
+              << "  " << program << " encode [--stats] <stages> <input> <output>\n"
+              << "  " << program << " decode [--stats] <input> <output>\n"
+              << "  " << program << " analyze [stages] <input>\n\n"
+              << "Stages are applied left to right, for example bwt,mtf,rle,lzma2.\n"
+              << "auto stands for the transforms which look best on samples of the\n"
+              << "input, for example auto,lzma2.\n"
+              << "sdelta takes a stride and an order, sdelta:4:2 subtracts the byte\n"
+              << "four positions back twice.\n"
+              << "Decoding reads the stages from the encoded file.\n"
+              << "--stats writes the time, bytes and allocations of the read, every\n"
+              << "stage and the write to standard error, one line per phase.\n"
+              << "analyze reports the entropy and byte statistics of the input and of\n"
+              << "the output of every given stage.\n\n"
+              << "Available stages: " << Pipeline::stageNames() << "\n";
+}
+
+static void printStats(const std::vector<Pipeline::StageStats> &stats)
+{
+    Pipeline::writeStats(std::cerr, stats);
+}
+
+static int encodeCommand(const std::string &stageList, const std::string &inputFileName,
+                         const std::string &outputFileName, bool stats)
+{
+    Pipeline pipeline;
+
+    if (!pipeline.setStagesForFile(stageList, inputFileName)) {
+        std::cerr << "Unknown stage in \"" << stageList << "\" or unreadable " << inputFileName << "\n";
+        return 1;
+    }
 
-    //    transAlgo.encodeFileWithBWT("movie.mp4", "movie.bwt");
-    //    transAlgo.encodeFileWithMTF("movie.bwt", "movie.mtf");
-    //    transAlgo.encodeFileWithRLE("movie.mtf", "movie.rle");
-    //    compAlgo.compressFileWithLZMA2("movie.rle", "movie.lzma2");
+    if (stageList.find("auto") != std::string::npos) {
+        std::cerr << "Selected stages: ";
+
+        for (size_t i = 0; i < pipeline.stages().size(); ++i) {
+            std::cerr << (i ? "," : "") << Pipeline::stageName(pipeline.stages()[i]);
+        }
+
+        std::cerr << (pipeline.stages().empty() ? "none\n" : "\n");
+    }
+
+    if (!pipeline.encodeFileWithPipeline(inputFileName, outputFileName,
+                                         stats ? printStats : Pipeline::StatsCallback())) {
+        std::cerr << "Encoding " << inputFileName << " failed\n";
+        return 1;
+    }
+
+    return 0;
+}
 
-    //    compAlgo.decompressFileWithLZMA2("movie.lzma2", "movie.r.rle");
-    //    transAlgo.decodeFileWithRLE("movie.r.rle", "movie.r.mtf");
-    //    transAlgo.decodeFileWithMTF("movie.r.mtf", "movie.r.bwt");
-    //    transAlgo.decodeFileWithBWT("movie.r.bwt", "movie.r.mp4");
+static int decodeCommand(const std::string &inputFileName, const std::string &outputFileName, bool stats)
+{
+    if (!Pipeline::decodeFileWithPipeline(inputFileName, outputFileName,
+                                          stats ? printStats : Pipeline::StatsCallback())) {
+        std::cerr << "Decoding " << inputFileName << " failed\n";
+        return 1;
+    }
 
+    return 0;
+}
 
-    //    transAlgo.encodeFileWithBWT("movie.mp4", "movie.bwt");
-    //    transAlgo.encodeFileWithRLE("movie.bwt", "movie.rle");
-    //    compAlgo.compressFileWithLZMA2("movie.rle", "movie.lzma2");
+static int analyzeCommand(const std::string &stageList, const std::string &inputFileName)
+{
+    Pipeline pipeline;
+    std::vector<EntropyReport> reports;
 
-    //    compAlgo.decompressFileWithLZMA2("movie.lzma2", "movie.r.rle");
-    //    transAlgo.decodeFileWithRLE("movie.r.rle", "movie.r.bwt");
-    //    transAlgo.decodeFileWithBWT("movie.r.bwt", "movie.r.mp4");
+    if (!stageList.empty() && !pipeline.setStages(stageList)) {
+        std::cerr << "Unknown stage in \"" << stageList << "\"\n";
+        return 1;
+    }
 
+    if (!pipeline.analyzeFileWithPipeline(inputFileName, reports)) {
+        std::cerr << "Analyzing " << inputFileName << " failed\n";
+        return 1;
+    }
 
-    // Only this pair meaningful and works together
-    transAlgo.encodeFileWithBWT("movie.mp4", "movie.bwt");
-    compAlgo.compressFileWithLZMA2("movie.bwt", "movie.lzma2");
+    EntropyAnalyzer::writeReport(std::cout, "input", reports.front());
 
-    compAlgo.decompressFileWithLZMA2("movie.lzma2", "movie.r.bwt");
-    transAlgo.decodeFileWithBWT("movie.r.bwt", "movie.r.mp4");
+    for (size_t i = 0; i < pipeline.stages().size(); ++i) {
+        EntropyAnalyzer::writeReport(std::cout, "after " + Pipeline::stageName(pipeline.stages()[i]),
+                                     reports[i + 1]);
+    }
 
     return 0;
 }
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::string> arguments(argv + 1, argv + argc);
+    bool stats = arguments.size() > 1 && arguments[1] == "--stats";
+
+    if (stats) {
+        arguments.erase(arguments.begin() + 1);
+    }
+
+    std::string command = arguments.empty() ? "" : arguments[0];
+
+    if (command == "encode" && arguments.size() == 4) {
+        return encodeCommand(arguments[1], arguments[2], arguments[3], stats);
+    }
+
+    if (command == "decode" && arguments.size() == 3) {
+        return decodeCommand(arguments[1], arguments[2], stats);
+    }
+
+    if (command == "analyze" && !stats && (arguments.size() == 2 || arguments.size() == 3)) {
+        return analyzeCommand((arguments.size() == 3) ? arguments[1] : "", arguments.back());
+    }
+
+    printUsage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,156 @@
+/******************************************************************************
+ * File Name    : matchfinder.cpp
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Hash Chain Match Finder For LZ Compressors
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#include "matchfinder.h"
+
+#include <algorithm>
+#include <cstring>
+
+static const unsigned MinHashBits = 12;
+static const unsigned MaxHashBits = 20;
+
+MatchFinder::MatchFinder(const uint8_t *data, size_t size, size_t windowSize, unsigned searchDepth) :
+    m_data(data),
+    m_size(size),
+    m_windowSize(windowSize),
+    m_searchDepth(std::max(1u, searchDepth)),
+    m_inserted(0)
+{
+    // The chain keeps one slot per position, it must outlive the window
+    size_t chainSize = 1;
+
+    while (chainSize <= std::min(windowSize, size)) {
+        chainSize <<= 1;
+    }
+
+    unsigned hashBits = MinHashBits;
+
+    while (hashBits < MaxHashBits && (size_t(1) << hashBits) < std::min(windowSize, size)) {
+        ++hashBits;
+    }
+
+    m_hashShift = 32 - hashBits;
+    m_chainMask = chainSize - 1;
+    m_heads.assign(size_t(1) << hashBits, NoPosition);
+    m_chain.assign(chainSize, NoPosition);
+    m_lastPair.assign(65536, NoPosition);
+    m_lastByte.assign(256, NoPosition);
+}
+
+MatchFinder::Match MatchFinder::find(size_t position, size_t maxLength)
+{
+    insertUpTo(position);
+
+    Match best;
+    maxLength = std::min(maxLength, m_size - position);
+
+    if (maxLength == 0) {
+        return best;
+    }
+
+    const uint8_t *current = m_data + position;
+
+    if (maxLength >= 3) {
+        size_t candidate = m_heads[hash(position)];
+
+        for (unsigned depth = m_searchDepth; depth > 0 && inWindow(candidate, position); --depth) {
+            const uint8_t *previous = m_data + candidate;
+
+            // A longer match has to differ from the best one at its end
+            if (previous[best.length] == current[best.length]) {
+                size_t length = matchLength(previous, current, maxLength);
+
+                if (length > best.length) {
+                    best.offset = position - candidate;
+                    best.length = length;
+
+                    if (length == maxLength) {
+                        break;
+                    }
+                }
+            }
+
+            candidate = m_chain[candidate & m_chainMask];
+        }
+    }
+
+    if (best.length < 2 && maxLength >= 2) {
+        size_t candidate = m_lastPair[(current[0] << 8) | current[1]];
+
+        if (inWindow(candidate, position)) {
+            best.offset = position - candidate;
+            best.length = matchLength(m_data + candidate, current, maxLength);
+        }
+    }
+
+    if (best.length < 1) {
+        size_t candidate = m_lastByte[current[0]];
+
+        if (inWindow(candidate, position)) {
+            best.offset = position - candidate;
+            best.length = 1;
+        }
+    }
+
+    return best;
+}
+
+size_t MatchFinder::matchLength(const uint8_t *first, const uint8_t *second, size_t maxLength)
+{
+    size_t length = 0;
+
+    while (length + 8 <= maxLength) {
+        uint64_t a;
+        uint64_t b;
+        std::memcpy(&a, first + length, 8);
+        std::memcpy(&b, second + length, 8);
+
+        if (a != b) {
+            return length + (__builtin_ctzll(a ^ b) >> 3);
+        }
+
+        length += 8;
+    }
+
+    while (length < maxLength && first[length] == second[length]) {
+        ++length;
+    }
+
+    return length;
+}
+
+void MatchFinder::insertUpTo(size_t position)
+{
+    for (; m_inserted < position; ++m_inserted) {
+        const uint8_t *current = m_data + m_inserted;
+
+        if (m_inserted + 3 <= m_size) {
+            uint32_t key = hash(m_inserted);
+            m_chain[m_inserted & m_chainMask] = m_heads[key];
+            m_heads[key] = m_inserted;
+        }
+
+        if (m_inserted + 2 <= m_size) {
+            m_lastPair[(current[0] << 8) | current[1]] = m_inserted;
+        }
+
+        m_lastByte[current[0]] = m_inserted;
+    }
+}
+
+uint32_t MatchFinder::hash(size_t position) const
+{
+    const uint8_t *current = m_data + position;
+    uint32_t prefix = (uint32_t(current[0]) << 16) | (uint32_t(current[1]) << 8) | current[2];
+    return (prefix * 2654435761u) >> m_hashShift;
+}
+
+bool MatchFinder::inWindow(size_t candidate, size_t position) const
+{
+    return candidate != NoPosition && position - candidate <= m_windowSize;
+}
@@ -0,0 +1,57 @@
+/******************************************************************************
+ * File Name    : matchfinder.h
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Hash Chain Match Finder For LZ Compressors
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#ifndef MATCHFINDER_H
+#define MATCHFINDER_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class MatchFinder
+{
+public:
+    struct Match {
+        size_t offset = 0;
+        size_t length = 0;
+    };
+
+    // Positions are chained by a hash of their first three bytes. Shorter
+    // matches come from the last occurrence of their two and one byte
+    // prefixes. At most searchDepth chain entries are compared per search.
+    MatchFinder(const uint8_t *data, size_t size, size_t windowSize, unsigned searchDepth);
+
+    // Returns the longest match of at most maxLength bytes which starts
+    // within windowSize bytes before position. Every position before the
+    // searched one is inserted first, so positions must not decrease.
+    Match find(size_t position, size_t maxLength);
+
+    static size_t matchLength(const uint8_t *first, const uint8_t *second, size_t maxLength);
+
+private:
+    void insertUpTo(size_t position);
+    uint32_t hash(size_t position) const;
+    bool inWindow(size_t candidate, size_t position) const;
+
+    static constexpr size_t NoPosition = SIZE_MAX;
+
+    const uint8_t *m_data;
+    size_t m_size;
+    size_t m_windowSize;
+    unsigned m_searchDepth;
+    unsigned m_hashShift;
+    size_t m_chainMask;
+    size_t m_inserted;
+
+    std::vector<size_t> m_heads;
+    std::vector<size_t> m_chain;
+    std::vector<size_t> m_lastPair;
+    std::vector<size_t> m_lastByte;
+};
+
+#endif // MATCHFINDER_H
@@ -0,0 +1,1218 @@
+/******************************************************************************
+ * File Name    : pipeline.cpp
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : In Memory Transformation And Compression Pipeline
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#include "pipeline.h"
+#include "fileio.h"
+
+#include "spscqueue.h"
+#include "allocationcounter.h"
+#include "threadpool.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+// The header is the magic, the format version, the stage count and one id
+// per stage in encoding order. Since version 2 the id of sdelta is followed
+// by its stride in four bytes and its order in one.
+static const uint8_t PipelineMagic[4] = { 'E', 'R', 'P', 'L' };
+static const uint8_t PipelineVersion = 2;
+static const size_t PipelineHeaderSize = 6;
+static const size_t StrideDeltaParameterSize = 5;
+static const size_t MaxStageCount = 255;
+
+// Chunks in flight between two stages
+static const size_t StreamQueueDepth = 4;
+static const size_t CubeSize = 64;
+
+// Transform selection keeps the best few chains of each length and
+// extends them by one more transform. Complement maps bytes one to one, so
+// it cannot change an entropy estimate and is not tried. Files larger
+// than one BWT block try the blocked BWT instead of the whole file one.
+static const Pipeline::Stage AutoTransforms[] = {
+    Pipeline::StageBWT, Pipeline::StageDelta, Pipeline::StageCube, Pipeline::StageBlockSort,
+    Pipeline::StagePB, Pipeline::StageMTF, Pipeline::StageRLE
+};
+// Stride deltas are tried for the strides above one whose bytes correlate
+// best with the samples, stride one is plain delta
+static const size_t AutoStrideCount = 2;
+static const double AutoMinAutocorrelation = 0.25;
+static const size_t AutoSampleCount = 8;
+static const size_t AutoSampleSize = 256 * 1024;
+static const size_t AutoMaxChainLength = 3;
+static const size_t AutoBeamWidth = 3;
+// A longer chain is only taken when it saves at least one percent
+static const uint64_t AutoMinGainPercent = 1;
+
+struct StreamChunk {
+    std::vector<uint8_t> data;
+    bool last = false;
+};
+
+struct StageEntry {
+    const char *name;
+    Pipeline::Stage stage;
+};
+
+static const StageEntry StageEntries[] = {
+    { "bwt", Pipeline::StageBWT },
+    { "bbwt", Pipeline::StageBlockedBWT },
+    { "delta", Pipeline::StageDelta },
+    { "sdelta", Pipeline::StageStrideDelta },
+    { "cube", Pipeline::StageCube },
+    { "complement", Pipeline::StageComplement },
+    { "blocksort", Pipeline::StageBlockSort },
+    { "pb", Pipeline::StagePB },
+    { "mtf", Pipeline::StageMTF },
+    { "rle", Pipeline::StageRLE },
+    { "trle", Pipeline::StageThresholdRLE },
+    { "lzma2", Pipeline::StageLZMA2 },
+    { "lz77", Pipeline::StageLZ77 },
+    { "lzss", Pipeline::StageLZSS },
+    { "lz78", Pipeline::StageLZ78 },
+    { "lzw", Pipeline::StageLZW },
+    { "rans", Pipeline::StageRANS },
+    { "cm", Pipeline::StageCM }
+};
+
+Pipeline::Pipeline()
+{
+}
+
+Pipeline::Pipeline(const std::vector<StageSpec> &stages) : m_stages(stages)
+{
+}
+
+bool Pipeline::setStages(const std::string &stageList)
+{
+    std::vector<StageSpec> stages;
+    size_t begin = 0;
+
+    while (begin <= stageList.size()) {
+        size_t end = std::min(stageList.find(',', begin), stageList.size());
+        StageSpec stage;
+
+        if (!stageFromName(stageList.substr(begin, end - begin), stage)) {
+            return false;
+        }
+
+        stages.push_back(stage);
+        begin = end + 1;
+    }
+
+    if (stages.size() > MaxStageCount) {
+        return false;
+    }
+
+    m_stages = stages;
+    return true;
+}
+
+const std::vector<Pipeline::StageSpec> &Pipeline::stages() const
+{
+    return m_stages;
+}
+
+bool Pipeline::setStagesForFile(const std::string &stageList, const std::string &inputFileName)
+{
+    if (stageList != "auto" && stageList.compare(0, 5, "auto,") != 0) {
+        return setStages(stageList);
+    }
+
+    Pipeline following;
+    std::vector<StageSpec> transforms;
+
+    if (stageList.size() > 5 && !following.setStages(stageList.substr(5))) {
+        return false;
+    }
+
+    if (!selectTransforms(inputFileName, transforms, following.stages())) {
+        return false;
+    }
+
+    transforms.insert(transforms.end(), following.stages().begin(), following.stages().end());
+
+    if (transforms.size() > MaxStageCount) {
+        return false;
+    }
+
+    m_stages = transforms;
+    return true;
+}
+
+// Reads a decimal number from 1 to maximum
+static bool parameterFromName(const std::string &name, uint32_t maximum, uint32_t &value)
+{
+    uint64_t number = 0;
+
+    if (name.empty() || name.size() > 10) {
+        return false;
+    }
+
+    for (char digit : name) {
+        if (digit < '0' || digit > '9') {
+            return false;
+        }
+
+        number = number * 10 + static_cast<uint64_t>(digit - '0');
+    }
+
+    if (number == 0 || number > maximum) {
+        return false;
+    }
+
+    value = static_cast<uint32_t>(number);
+    return true;
+}
+
+bool Pipeline::stageFromName(const std::string &name, StageSpec &stage)
+{
+    size_t colon = std::min(name.find(':'), name.size());
+    StageSpec parsed;
+    bool found = false;
+
+    for (const StageEntry &entry : StageEntries) {
+        if (name.compare(0, colon, entry.name) == 0) {
+            parsed.stage = entry.stage;
+            found = true;
+            break;
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    // sdelta takes an optional stride and then an optional order
+    if (colon < name.size()) {
+        if (parsed.stage != StageStrideDelta) {
+            return false;
+        }
+
+        std::string parameters = name.substr(colon + 1);
+        size_t orderColon = std::min(parameters.find(':'), parameters.size());
+
+        if (!parameterFromName(parameters.substr(0, orderColon), UINT32_MAX, parsed.stride)) {
+            return false;
+        }
+
+        if (orderColon < parameters.size() &&
+            !parameterFromName(parameters.substr(orderColon + 1), UINT8_MAX, parsed.order)) {
+            return false;
+        }
+    }
+
+    stage = parsed;
+    return true;
+}
+
+std::string Pipeline::stageName(const StageSpec &stage)
+{
+    for (const StageEntry &entry : StageEntries) {
+        if (stage.stage != entry.stage) {
+            continue;
+        }
+
+        if (stage.stride != 1 || stage.order != 1) {
+            return std::string(entry.name) + ":" + std::to_string(stage.stride) + ":" + std::to_string(stage.order);
+        }
+
+        return entry.name;
+    }
+
+    return std::string();
+}
+
+std::string Pipeline::stageNames()
+{
+    std::string names;
+
+    for (const StageEntry &entry : StageEntries) {
+        if (!names.empty()) {
+            names += ", ";
+        }
+
+        names += entry.name;
+    }
+
+    return names;
+}
+
+void Pipeline::writeStats(std::ostream &output, const std::vector<StageStats> &stats)
+{
+    for (const StageStats &phase : stats) {
+        output << "phase=" << phase.name
+               << " bytes_in=" << phase.bytesIn
+               << " bytes_out=" << phase.bytesOut
+               << " chunks=" << phase.chunks
+               << " wall_seconds=" << phase.wallSeconds
+               << " cpu_seconds=" << phase.cpuSeconds
+               << " allocations=" << phase.allocations
+               << " allocated_bytes=" << phase.allocatedBytes
+               << " peak_buffer_bytes=" << phase.peakBufferSize << "\n";
+    }
+}
+
+std::vector<Pipeline::StageSpec> Pipeline::allStages()
+{
+    std::vector<StageSpec> stages;
+
+    for (const StageEntry &entry : StageEntries) {
+        stages.push_back(entry.stage);
+    }
+
+    return stages;
+}
+
+void Pipeline::encodeStage(const StageSpec &stage, std::vector<uint8_t> &data)
+{
+    switch (stage.stage) {
+    case StageBWT:
+        encodeWithBWT(data);
+        break;
+    case StageBlockedBWT:
+        encodeWithBlockedBWT(data);
+        break;
+    case StageDelta:
+        encodeWithDelta(data);
+        break;
+    case StageStrideDelta:
+        encodeWithStrideDelta(data, stage.stride, stage.order);
+        break;
+    case StageCube:
+        encodeWithCube(data);
+        break;
+    case StageComplement:
+        encodeWithComplement(data);
+        break;
+    case StageBlockSort:
+        encodeWithBlockSort(data);
+        break;
+    case StagePB:
+        encodeWithPB(data);
+        break;
+    case StageMTF:
+        encodeWithMTF(data);
+        break;
+    case StageRLE:
+        encodeWithRLE(data);
+        break;
+    case StageThresholdRLE:
+        encodeWithThresholdRLE(data);
+        break;
+    default:
+        data = compressStage(stage.stage, data);
+        break;
+    }
+}
+
+void Pipeline::decodeStage(const StageSpec &stage, std::vector<uint8_t> &data)
+{
+    switch (stage.stage) {
+    case StageBWT:
+        decodeWithBWT(data);
+        break;
+    case StageBlockedBWT:
+        decodeWithBlockedBWT(data);
+        break;
+    case StageDelta:
+        decodeWithDelta(data);
+        break;
+    case StageStrideDelta: {
+        uint32_t stride;
+        uint32_t order;
+        getStrideDeltaHeader(data, stride, order);
+
+        if (stride != stage.stride || order != stage.order) {
+            throw std::runtime_error("Delta parameters do not match the pipeline header!");
+        }
+
+        decodeWithStrideDelta(data);
+        break;
+    }
+    case StageCube:
+        decodeWithCube(data);
+        break;
+    case StageComplement:
+        decodeWithComplement(data);
+        break;
+    case StageBlockSort:
+        decodeWithBlockSort(data);
+        break;
+    case StagePB:
+        decodeWithPB(data);
+        break;
+    case StageMTF:
+        decodeWithMTF(data);
+        break;
+    case StageRLE:
+        decodeWithRLE(data);
+        break;
+    case StageThresholdRLE:
+        decodeWithThresholdRLE(data);
+        break;
+    default:
+        data = decompressStage(stage.stage, data);
+        break;
+    }
+}
+
+bool Pipeline::isCompressionStage(Stage stage)
+{
+    return stage >= StageLZMA2 && stage <= StageCM;
+}
+
+std::vector<uint8_t> Pipeline::compressStage(Stage stage, const ByteView &data)
+{
+    switch (stage) {
+    case StageLZMA2:
+        return compressWithLZMA2(data);
+    case StageLZ77:
+        return compressWithLZ77(data);
+    case StageLZSS:
+        return compressWithLZSS(data);
+    case StageLZ78:
+        return compressWithLZ78(data);
+    case StageLZW:
+        return compressWithLZW(data);
+    case StageRANS:
+        return compressWithRANS(data);
+    case StageCM:
+        return compressWithCM(data);
+    default:
+        throw std::runtime_error("Unknown pipeline stage!");
+    }
+}
+
+std::vector<uint8_t> Pipeline::decompressStage(Stage stage, const ByteView &compressedData)
+{
+    switch (stage) {
+    case StageLZMA2:
+        return decompressWithLZMA2(compressedData);
+    case StageLZ77:
+        return decompressWithLZ77(compressedData);
+    case StageLZSS:
+        return decompressWithLZSS(compressedData);
+    case StageLZ78:
+        return decompressWithLZ78(compressedData);
+    case StageLZW:
+        return decompressWithLZW(compressedData);
+    case StageRANS:
+        return decompressWithRANS(compressedData);
+    case StageCM:
+        return decompressWithCM(compressedData);
+    default:
+        throw std::runtime_error("Unknown pipeline stage!");
+    }
+}
+
+// Collects the whole stream for kernels which need all of it at once
+static Pipeline::ChunkKernel gatherKernel(const std::function<void(std::vector<uint8_t> &)> &kernel)
+{
+    auto buffer = std::make_shared<std::vector<uint8_t>>();
+
+    return [kernel, buffer](std::vector<uint8_t> &chunk, bool last) {
+        if (buffer->empty()) {
+            buffer->swap(chunk);
+        } else {
+            buffer->insert(buffer->end(), chunk.begin(), chunk.end());
+        }
+
+        chunk.clear();
+
+        if (last) {
+            kernel(*buffer);
+            chunk.swap(*buffer);
+        }
+    };
+}
+
+// Passes whole multiples of alignment bytes and keeps the rest for the next
+// chunk, so block transforms see the same blocks as on the whole buffer
+static Pipeline::ChunkKernel alignedKernel(const std::function<void(std::vector<uint8_t> &)> &kernel,
+        size_t alignment)
+{
+    auto carry = std::make_shared<std::vector<uint8_t>>();
+
+    return [kernel, alignment, carry](std::vector<uint8_t> &chunk, bool last) {
+        if (!carry->empty()) {
+            chunk.insert(chunk.begin(), carry->begin(), carry->end());
+            carry->clear();
+        }
+
+        if (!last) {
+            size_t alignedSize = chunk.size() - chunk.size() % alignment;
+            carry->assign(chunk.begin() + alignedSize, chunk.end());
+            chunk.resize(alignedSize);
+        }
+
+        kernel(chunk);
+    };
+}
+
+Pipeline::ChunkKernel Pipeline::encodeKernel(const StageSpec &stage)
+{
+    switch (stage.stage) {
+    case StageDelta:
+        return [previous = uint8_t(0)](std::vector<uint8_t> &chunk, bool) mutable {
+            encodeChunkWithDelta(chunk, previous);
+        };
+    case StageCube:
+        return alignedKernel(&Pipeline::encodeWithCube, CubeSize);
+    case StageMTF:
+        return [dict = initialMTFDictionary()](std::vector<uint8_t> &chunk, bool) mutable {
+            encodeChunkWithMTF(chunk, dict);
+        };
+    case StageRLE:
+        return [state = RLEState()](std::vector<uint8_t> &chunk, bool last) mutable {
+            encodeChunkWithRLE(chunk, state, last);
+        };
+    case StageLZMA2: {
+        auto coder = std::make_shared<LZMA2ChunkCoder>(true);
+
+        return [coder](std::vector<uint8_t> &chunk, bool last) {
+            coder->code(chunk, last);
+        };
+    }
+    default:
+        return gatherKernel([stage](std::vector<uint8_t> &data) {
+            encodeStage(stage, data);
+        });
+    }
+}
+
+Pipeline::ChunkKernel Pipeline::decodeKernel(const StageSpec &stage)
+{
+    switch (stage.stage) {
+    case StageDelta:
+        return [previous = uint8_t(0)](std::vector<uint8_t> &chunk, bool) mutable {
+            decodeChunkWithDelta(chunk, previous);
+        };
+    case StageCube:
+        return alignedKernel(&Pipeline::decodeWithCube, CubeSize);
+    case StageMTF:
+        return [dict = initialMTFDictionary()](std::vector<uint8_t> &chunk, bool) mutable {
+            decodeChunkWithMTF(chunk, dict);
+        };
+    case StageRLE:
+        return [state = RLEState()](std::vector<uint8_t> &chunk, bool) mutable {
+            decodeChunkWithRLE(chunk, state);
+        };
+    case StageLZMA2: {
+        auto coder = std::make_shared<LZMA2ChunkCoder>(false);
+
+        return [coder](std::vector<uint8_t> &chunk, bool last) {
+            coder->code(chunk, last);
+        };
+    }
+    default:
+        return gatherKernel([stage](std::vector<uint8_t> &data) {
+            decodeStage(stage, data);
+        });
+    }
+}
+
+static double cpuSeconds(clockid_t clock)
+{
+    timespec time;
+    clock_gettime(clock, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+// Runs call and adds its cost to stats when given. The bytes are taken
+// from chunk before and after the call.
+template <typename Call>
+static void measuredCall(Pipeline::StageStats *stats, const std::vector<uint8_t> &chunk, const Call &call)
+{
+    if (!stats) {
+        call();
+        return;
+    }
+
+    AllocationCounter::Scope counting;
+    size_t bytesIn = chunk.size();
+    auto wallStart = std::chrono::steady_clock::now();
+    double cpuStart = cpuSeconds(CLOCK_THREAD_CPUTIME_ID);
+    uint64_t allocations = AllocationCounter::allocations();
+    uint64_t allocatedBytes = AllocationCounter::allocatedBytes();
+
+    call();
+
+    stats->wallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    stats->cpuSeconds += cpuSeconds(CLOCK_THREAD_CPUTIME_ID) - cpuStart;
+    stats->allocations += AllocationCounter::allocations() - allocations;
+    stats->allocatedBytes += AllocationCounter::allocatedBytes() - allocatedBytes;
+    stats->bytesIn += bytesIn;
+    stats->bytesOut += chunk.size();
+    stats->chunks++;
+    stats->peakBufferSize = std::max(stats->peakBufferSize, chunk.capacity());
+}
+
+std::vector<Pipeline::StageStats> Pipeline::makeStats(const std::vector<StageSpec> &stages)
+{
+    std::vector<StageStats> stats(stages.size() + 3);
+    stats.front().name = "read";
+
+    for (size_t i = 0; i < stages.size(); ++i) {
+        stats[i + 1].name = stageName(stages[i]);
+    }
+
+    stats[stages.size() + 1].name = "write";
+    stats.back().name = "total";
+    return stats;
+}
+
+void Pipeline::runChunkKernels(const std::vector<ChunkKernel> &kernels,
+                               const std::function<bool(std::vector<uint8_t> &)> &source,
+                               const std::function<void(const std::vector<uint8_t> &)> &sink,
+                               std::vector<StageStats> *stats)
+{
+    if (stats && stats->size() != kernels.size() + 3) {
+        throw std::runtime_error("Stats do not match the pipeline stages!");
+    }
+
+    // Each entry is written by the thread of its phase only
+    auto phaseStats = [stats](size_t phase) {
+        return stats ? &(*stats)[phase] : nullptr;
+    };
+
+    auto wallStart = std::chrono::steady_clock::now();
+    double cpuStart = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID);
+
+    std::vector<std::unique_ptr<SPSCQueue<StreamChunk>>> queues;
+
+    for (size_t i = 0; i <= kernels.size(); ++i) {
+        queues.emplace_back(new SPSCQueue<StreamChunk>(StreamQueueDepth));
+    }
+
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    // Cancelling the queues makes every blocked or later push and pop
+    // return false, so the other threads stop
+    auto fail = [&]() {
+        std::lock_guard<std::mutex> lock(errorMutex);
+
+        if (!error) {
+            error = std::current_exception();
+        }
+
+        for (auto &queue : queues) {
+            queue->cancel();
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    threads.emplace_back([&]() {
+        try {
+            StreamChunk chunk;
+            bool read = true;
+
+            for (;;) {
+                measuredCall(phaseStats(0), chunk.data, [&]() {
+                    read = source(chunk.data);
+                });
+
+                if (!read) {
+                    break;
+                }
+
+                if (!queues.front()->push(chunk)) {
+                    return;
+                }
+            }
+
+            chunk.data.clear();
+            chunk.last = true;
+            queues.front()->push(chunk);
+        } catch (...) {
+            fail();
+        }
+    });
+
+    for (size_t i = 0; i < kernels.size(); ++i) {
+        threads.emplace_back([&, i]() {
+            try {
+                StreamChunk chunk;
+
+                do {
+                    if (!queues[i]->pop(chunk)) {
+                        return;
+                    }
+
+                    measuredCall(phaseStats(i + 1), chunk.data, [&]() {
+                        kernels[i](chunk.data, chunk.last);
+                    });
+
+                    // A larger output, such as a gathered stream, goes on in
+                    // chunks of the read size so the next stage can stream it
+                    size_t offset = 0;
+
+                    while (chunk.data.size() - offset > FileReader::DefaultChunkSize) {
+                        StreamChunk piece;
+                        piece.data.assign(chunk.data.begin() + offset,
+                                          chunk.data.begin() + offset + FileReader::DefaultChunkSize);
+                        offset += FileReader::DefaultChunkSize;
+
+                        if (!queues[i + 1]->push(piece)) {
+                            return;
+                        }
+                    }
+
+                    chunk.data.erase(chunk.data.begin(), chunk.data.begin() + offset);
+
+                    // Chunks a kernel keeps for later are not passed on
+                    if ((chunk.last || !chunk.data.empty()) && !queues[i + 1]->push(chunk)) {
+                        return;
+                    }
+                } while (!chunk.last);
+            } catch (...) {
+                fail();
+            }
+        });
+    }
+
+    try {
+        StreamChunk chunk;
+
+        do {
+            if (!queues.back()->pop(chunk)) {
+                break;
+            }
+
+            measuredCall(phaseStats(kernels.size() + 1), chunk.data, [&]() {
+                sink(chunk.data);
+            });
+        } while (!chunk.last);
+    } catch (...) {
+        fail();
+    }
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    if (stats) {
+        StageStats &read = stats->front();
+        StageStats &write = (*stats)[kernels.size() + 1];
+        StageStats &total = stats->back();
+        read.bytesIn = read.bytesOut;
+        total.bytesIn = read.bytesOut;
+        total.bytesOut = write.bytesOut;
+        total.chunks = write.chunks;
+        total.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        total.cpuSeconds = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID) - cpuStart;
+
+        for (size_t i = 0; i + 1 < stats->size(); ++i) {
+            total.allocations += (*stats)[i].allocations;
+            total.allocatedBytes += (*stats)[i].allocatedBytes;
+            total.peakBufferSize = std::max(total.peakBufferSize, (*stats)[i].peakBufferSize);
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void Pipeline::putHeader(std::vector<uint8_t> &output, const std::vector<StageSpec> &stages)
+{
+    if (stages.size() > MaxStageCount) {
+        throw std::runtime_error("Too many pipeline stages!");
+    }
+
+    output.insert(output.end(), PipelineMagic, PipelineMagic + sizeof(PipelineMagic));
+    output.push_back(PipelineVersion);
+    output.push_back(static_cast<uint8_t>(stages.size()));
+
+    for (const StageSpec &stage : stages) {
+        output.push_back(stage.stage);
+
+        if (stage.stage == StageStrideDelta) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                output.push_back(static_cast<uint8_t>(stage.stride >> shift));
+            }
+
+            output.push_back(static_cast<uint8_t>(stage.order));
+        }
+    }
+}
+
+size_t Pipeline::getHeader(const ByteView &input, std::vector<StageSpec> &stages)
+{
+    if (input.size() < PipelineHeaderSize || std::memcmp(input.data(), PipelineMagic, sizeof(PipelineMagic)) != 0) {
+        throw std::runtime_error("Invalid pipeline header!");
+    }
+
+    // Version 1 wrote no parameters, its sdelta always had the defaults
+    uint8_t version = input[4];
+
+    if (version != 1 && version != PipelineVersion) {
+        throw std::runtime_error("Unsupported pipeline version!");
+    }
+
+    size_t stageCount = input[5];
+    size_t offset = PipelineHeaderSize;
+    stages.clear();
+
+    for (size_t i = 0; i < stageCount; ++i) {
+        if (offset >= input.size()) {
+            throw std::runtime_error("Invalid pipeline header!");
+        }
+
+        StageSpec stage(static_cast<Stage>(input[offset++]));
+
+        if (stageName(stage).empty()) {
+            throw std::runtime_error("Unknown pipeline stage!");
+        }
+
+        if (stage.stage == StageStrideDelta && version >= 2) {
+            if (input.size() - offset < StrideDeltaParameterSize) {
+                throw std::runtime_error("Invalid pipeline header!");
+            }
+
+            stage.stride = 0;
+
+            for (int shift = 0; shift < 32; shift += 8) {
+                stage.stride |= static_cast<uint32_t>(input[offset++]) << shift;
+            }
+
+            stage.order = input[offset++];
+
+            if (stage.stride == 0 || stage.order == 0) {
+                throw std::runtime_error("Invalid pipeline header!");
+            }
+        }
+
+        stages.push_back(stage);
+    }
+
+    return offset;
+}
+
+std::vector<uint8_t> Pipeline::encode(std::vector<uint8_t> data) const
+{
+    for (const StageSpec &stage : m_stages) {
+        encodeStage(stage, data);
+    }
+
+    std::vector<uint8_t> encodedData;
+    encodedData.reserve(PipelineHeaderSize + m_stages.size() * (1 + StrideDeltaParameterSize) + data.size());
+    putHeader(encodedData, m_stages);
+    encodedData.insert(encodedData.end(), data.begin(), data.end());
+    return encodedData;
+}
+
+std::vector<uint8_t> Pipeline::decode(const ByteView &encodedData)
+{
+    std::vector<StageSpec> stages;
+    size_t headerSize = getHeader(encodedData, stages);
+    ByteView payload = encodedData.subview(headerSize, encodedData.size() - headerSize);
+    auto stage = stages.rbegin();
+    std::vector<uint8_t> data;
+
+    // A compressor reads the payload in place, transforms need their copy
+    if (stage != stages.rend() && isCompressionStage(stage->stage)) {
+        data = decompressStage((stage++)->stage, payload);
+    } else {
+        data.assign(payload.begin(), payload.end());
+    }
+
+    for (; stage != stages.rend(); ++stage) {
+        decodeStage(*stage, data);
+    }
+
+    return data;
+}
+
+// Reads the header byte by byte past the stage entries, getHeader checks it
+static bool getHeaderFromFile(FileReader &inputFile, std::vector<uint8_t> &header)
+{
+    header.resize(PipelineHeaderSize);
+
+    if (inputFile.read(header.data(), header.size()) != header.size()) {
+        return false;
+    }
+
+    size_t stageCount = header[5];
+
+    for (size_t i = 0; i < stageCount; ++i) {
+        uint8_t stage;
+
+        if (inputFile.read(&stage, 1) != 1) {
+            return false;
+        }
+
+        header.push_back(stage);
+
+        if (stage == Pipeline::StageStrideDelta && header[4] >= 2) {
+            size_t offset = header.size();
+            header.resize(offset + StrideDeltaParameterSize);
+
+            if (inputFile.read(header.data() + offset, StrideDeltaParameterSize) != StrideDeltaParameterSize) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool Pipeline::encodeFileWithPipeline(const std::string &inputFileName, const std::string &outputFileName,
+                                      const StatsCallback &statsCallback) const
+{
+    FileReader inputFile(inputFileName);
+
+    if (!inputFile.isOpen()) {
+        return false;
+    }
+
+    try {
+        std::vector<ChunkKernel> kernels;
+
+        for (const StageSpec &stage : m_stages) {
+            kernels.push_back(encodeKernel(stage));
+        }
+
+        FileWriter outputFile(outputFileName);
+
+        if (!outputFile.isOpen()) {
+            return false;
+        }
+
+        std::vector<uint8_t> header;
+        putHeader(header, m_stages);
+        outputFile.write(header);
+
+        std::vector<StageStats> stats = makeStats(m_stages);
+
+        runChunkKernels(kernels, [&inputFile](std::vector<uint8_t> &chunk) {
+            return inputFile.readChunk(chunk);
+        }, [&outputFile](const std::vector<uint8_t> &chunk) {
+            outputFile.write(chunk);
+        }, statsCallback ? &stats : nullptr);
+
+        outputFile.close();
+
+        if (statsCallback) {
+            statsCallback(stats);
+        }
+    } catch (const std::exception &e) {
+        return false;
+    }
+
+    return true;
+}
+
+bool Pipeline::decodeFileWithPipeline(const std::string &inputFileName, const std::string &outputFileName,
+                                      const StatsCallback &statsCallback)
+{
+    FileReader inputFile(inputFileName);
+
+    if (!inputFile.isOpen()) {
+        return false;
+    }
+
+    try {
+        std::vector<uint8_t> header;
+        std::vector<StageSpec> stages;
+
+        if (!getHeaderFromFile(inputFile, header)) {
+            return false;
+        }
+
+        getHeader(header, stages);
+        std::vector<ChunkKernel> kernels;
+
+        for (auto stage = stages.rbegin(); stage != stages.rend(); ++stage) {
+            kernels.push_back(decodeKernel(*stage));
+        }
+
+        FileWriter outputFile(outputFileName);
+
+        if (!outputFile.isOpen()) {
+            return false;
+        }
+
+        std::vector<StageStats> stats = makeStats(std::vector<StageSpec>(stages.rbegin(), stages.rend()));
+
+        runChunkKernels(kernels, [&inputFile](std::vector<uint8_t> &chunk) {
+            return inputFile.readChunk(chunk);
+        }, [&outputFile](const std::vector<uint8_t> &chunk) {
+            outputFile.write(chunk);
+        }, statsCallback ? &stats : nullptr);
+
+        outputFile.close();
+
+        if (statsCallback) {
+            statsCallback(stats);
+        }
+    } catch (const std::exception &e) {
+        return false;
+    }
+
+    return true;
+}
+
+// Passes the chunks on unchanged and reports them when the stream ends
+static Pipeline::ChunkKernel analyzerKernel(ThreadPool &pool, EntropyReport &report)
+{
+    auto analyzer = std::make_shared<EntropyAnalyzer>(&pool);
+
+    return [analyzer, &report](std::vector<uint8_t> &chunk, bool last) {
+        analyzer->update(chunk);
+
+        if (last) {
+            report = analyzer->finish();
+        }
+    };
+}
+
+bool Pipeline::analyzeFileWithPipeline(const std::string &inputFileName, std::vector<EntropyReport> &reports) const
+{
+    FileReader inputFile(inputFileName);
+
+    if (!inputFile.isOpen()) {
+        return false;
+    }
+
+    try {
+        // Shared by the analyzers, each runs on the thread of its kernel
+        ThreadPool pool;
+        std::vector<ChunkKernel> kernels;
+        reports.assign(m_stages.size() + 1, EntropyReport());
+        kernels.push_back(analyzerKernel(pool, reports.front()));
+
+        for (size_t i = 0; i < m_stages.size(); ++i) {
+            kernels.push_back(encodeKernel(m_stages[i]));
+            kernels.push_back(analyzerKernel(pool, reports[i + 1]));
+        }
+
+        runChunkKernels(kernels, [&inputFile](std::vector<uint8_t> &chunk) {
+            return inputFile.readChunk(chunk);
+        }, [](const std::vector<uint8_t> &) {
+        });
+    } catch (const std::exception &e) {
+        return false;
+    }
+
+    return true;
+}
+
+struct AutoCandidate {
+    std::vector<Pipeline::StageSpec> stages;
+    std::vector<std::vector<uint8_t>> samples;
+    uint64_t estimate = 0;
+    size_t parent = 0;
+};
+
+// Order one entropy plus a byte for each pair seen, so that the sparse
+// contexts of a small sample do not look cheaper than they are
+static uint64_t estimatedSize(const ByteView &data)
+{
+    EntropyReport report = EntropyAnalyzer::analyze(data);
+    uint64_t order1Size = static_cast<uint64_t>(report.order1Entropy() * report.size / 8) + report.distinctPairs();
+    return std::min(report.order0Size() + report.distinctBytes(), order1Size);
+}
+
+// Sums the estimates of the samples, a chain which failed on any sample
+// gets the largest estimate
+static void sumEstimates(std::vector<AutoCandidate> &candidates, const std::vector<uint64_t> &estimates)
+{
+    size_t sampleCount = estimates.size() / std::max<size_t>(candidates.size(), 1);
+
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        candidates[i].estimate = 0;
+
+        for (size_t j = 0; j < sampleCount; ++j) {
+            uint64_t estimate = estimates[i * sampleCount + j];
+            bool failed = (estimate == UINT64_MAX || candidates[i].estimate == UINT64_MAX);
+            candidates[i].estimate = failed ? UINT64_MAX : candidates[i].estimate + estimate;
+        }
+    }
+}
+
+// The fixed transforms, then sdelta with the best correlated strides
+static std::vector<Pipeline::StageSpec> autoTransforms(const std::vector<std::vector<uint8_t>> &samples,
+        size_t fileSize)
+{
+    std::vector<Pipeline::StageSpec> transforms;
+
+    for (Pipeline::Stage transform : AutoTransforms) {
+        bool blocked = (transform == Pipeline::StageBWT && fileSize > TransformationAlgorithms::DefaultBWTBlockSize);
+        transforms.push_back(blocked ? Pipeline::StageBlockedBWT : transform);
+    }
+
+    std::vector<double> correlations(EntropyReport::MaxStride + 1, 0);
+
+    for (const std::vector<uint8_t> &sample : samples) {
+        EntropyReport report = EntropyAnalyzer::analyze(sample);
+
+        for (size_t stride = 2; stride <= EntropyReport::MaxStride; ++stride) {
+            correlations[stride] += report.autocorrelation(stride) / samples.size();
+        }
+    }
+
+    std::vector<size_t> strides;
+
+    for (size_t stride = 2; stride <= EntropyReport::MaxStride; ++stride) {
+        if (correlations[stride] >= AutoMinAutocorrelation) {
+            strides.push_back(stride);
+        }
+    }
+
+    std::stable_sort(strides.begin(), strides.end(), [&correlations](size_t a, size_t b) {
+        return correlations[a] > correlations[b];
+    });
+    strides.resize(std::min(strides.size(), AutoStrideCount));
+
+    for (size_t stride : strides) {
+        transforms.push_back(Pipeline::StageSpec(Pipeline::StageStrideDelta, static_cast<uint32_t>(stride)));
+    }
+
+    return transforms;
+}
+
+bool Pipeline::selectTransforms(const std::string &inputFileName, std::vector<StageSpec> &transforms,
+                                const std::vector<StageSpec> &followingStages)
+{
+    MappedFile inputFile(inputFileName);
+
+    if (!inputFile.isOpen()) {
+        return false;
+    }
+
+    try {
+        ByteView data = inputFile.view();
+        std::vector<AutoCandidate> beam(1);
+
+        // Small files are tried whole, larger ones by evenly spread samples
+        if (data.size() <= AutoSampleCount * AutoSampleSize) {
+            beam.front().samples.emplace_back(data.begin(), data.end());
+        } else {
+            for (size_t i = 0; i < AutoSampleCount; ++i) {
+                ByteView sample = data.subview((data.size() - AutoSampleSize) / (AutoSampleCount - 1) * i,
+                                               AutoSampleSize);
+                beam.front().samples.emplace_back(sample.begin(), sample.end());
+            }
+        }
+
+        std::vector<StageSpec> autoStages = autoTransforms(beam.front().samples, data.size());
+        inputFile.close();
+
+        for (const std::vector<uint8_t> &sample : beam.front().samples) {
+            beam.front().estimate += estimatedSize(sample);
+        }
+
+        // The empty chain and the best chain of each length
+        std::vector<AutoCandidate> finalists(1, beam.front());
+        size_t sampleCount = beam.front().samples.size();
+        ThreadPool pool;
+
+        for (size_t length = 1; length <= AutoMaxChainLength && !beam.empty(); ++length) {
+            std::vector<AutoCandidate> candidates;
+
+            for (size_t parent = 0; parent < beam.size(); ++parent) {
+                for (const StageSpec &transform : autoStages) {
+                    // A transform right after itself is never better than once,
+                    // except delta where twice is a second order delta
+                    if (!beam[parent].stages.empty() && beam[parent].stages.back() == transform &&
+                        transform.stage != StageDelta) {
+                        continue;
+                    }
+
+                    AutoCandidate candidate;
+                    candidate.stages = beam[parent].stages;
+                    candidate.stages.push_back(transform);
+                    candidate.samples.resize(sampleCount);
+                    candidate.parent = parent;
+                    candidates.push_back(std::move(candidate));
+                }
+            }
+
+            std::vector<uint64_t> estimates(candidates.size() * sampleCount);
+
+            // Every chain and sample pair is one task, a chain only applies
+            // its last transform to the samples of its parent
+            pool.parallelFor(estimates.size(), [&](size_t task) {
+                AutoCandidate &candidate = candidates[task / sampleCount];
+                std::vector<uint8_t> sample = beam[candidate.parent].samples[task % sampleCount];
+
+                try {
+                    encodeStage(candidate.stages.back(), sample);
+                    estimates[task] = estimatedSize(sample);
+                } catch (const std::exception &e) {
+                    estimates[task] = UINT64_MAX;
+                }
+
+                candidate.samples[task % sampleCount] = std::move(sample);
+            });
+
+            sumEstimates(candidates, estimates);
+            std::stable_sort(candidates.begin(), candidates.end(), [](const AutoCandidate &a, const AutoCandidate &b) {
+                return a.estimate < b.estimate;
+            });
+            candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [](const AutoCandidate &candidate) {
+                return candidate.estimate == UINT64_MAX;
+            }), candidates.end());
+            candidates.resize(std::min(candidates.size(), AutoBeamWidth));
+
+            if (!candidates.empty()) {
+                finalists.push_back(candidates.front());
+            }
+
+            beam = std::move(candidates);
+        }
+
+        if (!followingStages.empty()) {
+            std::vector<uint64_t> sizes(finalists.size() * sampleCount);
+
+            pool.parallelFor(sizes.size(), [&](size_t task) {
+                std::vector<uint8_t> &sample = finalists[task / sampleCount].samples[task % sampleCount];
+
+                try {
+                    for (const StageSpec &stage : followingStages) {
+                        encodeStage(stage, sample);
+                    }
+
+                    sizes[task] = sample.size();
+                } catch (const std::exception &e) {
+                    sizes[task] = UINT64_MAX;
+                }
+            });
+
+            sumEstimates(finalists, sizes);
+        }
+
+        // Finalists are in order of length, a longer chain has to save at
+        // least AutoMinGainPercent over the best shorter one
+        size_t best = 0;
+
+        for (size_t i = 1; i < finalists.size(); ++i) {
+            if (finalists[i].estimate < UINT64_MAX &&
+                finalists[i].estimate * 100 < finalists[best].estimate * (100 - AutoMinGainPercent)) {
+                best = i;
+            }
+        }
+
+        transforms = finalists[best].stages;
+    } catch (const std::exception &e) {
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,173 @@
+/******************************************************************************
+ * File Name    : pipeline.h
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : In Memory Transformation And Compression Pipeline
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <functional>
+#include <cstdint>
+
+#include "compressionalgorithms.h"
+#include "transformationalgorithms.h"
+#include "entropyanalyzer.h"
+
+class Pipeline : public CompressionAlgorithms, public TransformationAlgorithms
+{
+public:
+    // Stage ids are written to the pipeline header, so existing values must
+    // never change
+    enum Stage : uint8_t {
+        StageBWT = 1,
+        StageBlockedBWT,
+        StageDelta,
+        StageStrideDelta,
+        StageCube,
+        StageComplement,
+        StageBlockSort,
+        StagePB,
+        StageMTF,
+        StageRLE,
+        StageThresholdRLE,
+        StageLZMA2,
+        StageLZ77,
+        StageLZSS,
+        StageLZ78,
+        StageLZW,
+        StageRANS,
+        StageCM
+    };
+
+    // A stage with its parameters, only sdelta takes any so far. They are
+    // written to the pipeline header after the stage id.
+    struct StageSpec {
+        StageSpec(Stage stage = StageBWT, uint32_t stride = 1, uint32_t order = 1) : stage(stage), stride(stride),
+            order(order)
+        {
+        }
+
+        bool operator==(const StageSpec &other) const
+        {
+            return stage == other.stage && stride == other.stride && order == other.order;
+        }
+
+        Stage stage;
+        uint32_t stride;
+        uint32_t order;
+    };
+
+    // Every chunk of a stream is passed with last unset, then a final and
+    // possibly empty chunk with last set
+    typedef std::function<void(std::vector<uint8_t> &, bool)> ChunkKernel;
+
+    // Measured for the read, every stage, the write and the whole run when a
+    // stats callback is given. Phase times cover the work on chunks and not
+    // the waits between threads. The read and the write count the bytes they
+    // move as both input and output.
+    struct StageStats {
+        std::string name;
+        uint64_t bytesIn = 0;
+        uint64_t bytesOut = 0;
+        uint64_t chunks = 0;
+        double wallSeconds = 0;
+        double cpuSeconds = 0;
+        // Made with operator new on the thread of the phase
+        uint64_t allocations = 0;
+        uint64_t allocatedBytes = 0;
+        // Largest chunk buffer capacity the phase handed on
+        size_t peakBufferSize = 0;
+    };
+
+    typedef std::function<void(const std::vector<StageStats> &)> StatsCallback;
+
+    Pipeline();
+    explicit Pipeline(const std::vector<StageSpec> &stages);
+
+    // Takes a comma separated stage list such as "bwt,mtf,rle,lzma2".
+    // Parameters follow a stage name after colons, "sdelta:4:2" is a stride
+    // delta with stride 4 and order 2. Returns false and keeps the current
+    // stages on an unknown name or invalid parameters.
+    bool setStages(const std::string &stageList);
+    const std::vector<StageSpec> &stages() const;
+    // Like setStages, but a list starting with "auto" gets the transforms
+    // selectTransforms picks for the file in front of the other stages
+    bool setStagesForFile(const std::string &stageList, const std::string &inputFileName);
+
+    // Tries chains of up to three transforms on samples of the file, ranked
+    // by an entropy estimate of their output. Stride deltas are tried with
+    // the strides the samples correlate best at, and files larger than a
+    // BWT block try the blocked BWT. The best chain of each length and the
+    // empty chain are then run through the following stages and the
+    // smallest output wins. Without following stages the estimate decides
+    // alone.
+    static bool selectTransforms(const std::string &inputFileName, std::vector<StageSpec> &transforms,
+                                 const std::vector<StageSpec> &followingStages = std::vector<StageSpec>());
+
+    static bool stageFromName(const std::string &name, StageSpec &stage);
+    // Parameters are only named when they are not the defaults
+    static std::string stageName(const StageSpec &stage);
+    static std::string stageNames();
+    static std::vector<StageSpec> allStages();
+
+    // One logfmt line per phase, such as "phase=bwt bytes_in=... cpu_seconds=..."
+    static void writeStats(std::ostream &output, const std::vector<StageStats> &stats);
+
+    // The output starts with a header listing the stages, so decoding
+    // needs no stage list and runs their inverses in reverse order
+    std::vector<uint8_t> encode(std::vector<uint8_t> data) const;
+    static std::vector<uint8_t> decode(const ByteView &encodedData);
+
+    // Files are streamed through the stages in chunks with one thread per
+    // stage, the output is the same as encode gives. A given callback gets
+    // the stats of a successful run, measuring costs nothing otherwise.
+    bool encodeFileWithPipeline(const std::string &inputFileName, const std::string &outputFileName,
+                                const StatsCallback &statsCallback = StatsCallback()) const;
+    static bool decodeFileWithPipeline(const std::string &inputFileName, const std::string &outputFileName,
+                                       const StatsCallback &statsCallback = StatsCallback());
+
+    // Streams the file through the stages without writing anything and
+    // reports the data before the first stage and after every stage
+    bool analyzeFileWithPipeline(const std::string &inputFileName, std::vector<EntropyReport> &reports) const;
+
+protected:
+    // Buffers move from stage to stage, in place transforms keep theirs
+    static void encodeStage(const StageSpec &stage, std::vector<uint8_t> &data);
+    static void decodeStage(const StageSpec &stage, std::vector<uint8_t> &data);
+
+    // Compressors read a view, so the first stage can skip a copy
+    static bool isCompressionStage(Stage stage);
+    static std::vector<uint8_t> compressStage(Stage stage, const ByteView &data);
+    static std::vector<uint8_t> decompressStage(Stage stage, const ByteView &compressedData);
+
+    // Delta, Cube, MTF, RLE and LZMA2 work on each chunk as it comes, the
+    // other stages collect the whole stream first
+    static ChunkKernel encodeKernel(const StageSpec &stage);
+    static ChunkKernel decodeKernel(const StageSpec &stage);
+    // Runs each kernel on its own thread, chunks move between them through
+    // bounded queues which spin briefly and then block. Outputs larger than
+    // a read chunk are split into read sized chunks. Rethrows the first
+    // exception of any thread. Given stats must hold the read, one entry per
+    // kernel, the write and the total in this order.
+    static void runChunkKernels(const std::vector<ChunkKernel> &kernels,
+                                const std::function<bool(std::vector<uint8_t> &)> &source,
+                                const std::function<void(const std::vector<uint8_t> &)> &sink,
+                                std::vector<StageStats> *stats = nullptr);
+    // Named entries for runChunkKernels with stages in kernel order
+    static std::vector<StageStats> makeStats(const std::vector<StageSpec> &stages);
+
+    static void putHeader(std::vector<uint8_t> &output, const std::vector<StageSpec> &stages);
+    // Returns the header size, throws on an invalid header
+    static size_t getHeader(const ByteView &input, std::vector<StageSpec> &stages);
+
+private:
+    std::vector<StageSpec> m_stages;
+};
+
+#endif // PIPELINE_H
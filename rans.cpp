@@ -0,0 +1,284 @@
+/******************************************************************************
+ * File Name    : rans.cpp
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Four Way Interleaved Order-0 rANS Entropy Coder
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#include "rans.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+static const uint32_t ScaleBits = 12;
+static const uint32_t TotalFrequency = 1 << ScaleBits;
+static const uint32_t SlotMask = TotalFrequency - 1;
+// States stay in [LowerBound, LowerBound << 16) between symbols, so a
+// symbol moves at most one 16 bit word and states fit the reciprocals
+static const uint32_t LowerBound = 1u << 15;
+static const unsigned StreamCount = 4;
+static const size_t BlockHeaderSize = 8;
+static const size_t SymbolMapSize = 32;
+
+static void putUint32(std::vector<uint8_t> &output, uint32_t value)
+{
+    for (unsigned i = 0; i < 4; ++i) {
+        output.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+}
+
+static uint32_t getUint32(const uint8_t *buffer)
+{
+    return static_cast<uint32_t>(buffer[0])
+           | (static_cast<uint32_t>(buffer[1]) << 8)
+           | (static_cast<uint32_t>(buffer[2]) << 16)
+           | (static_cast<uint32_t>(buffer[3]) << 24);
+}
+
+// Scales the counts to sum up to TotalFrequency, every present symbol
+// keeps at least one slot
+static void normalizeFrequencies(const uint64_t *counts, uint64_t total, uint32_t *frequencies)
+{
+    uint32_t sum = 0;
+
+    for (unsigned s = 0; s < 256; ++s) {
+        frequencies[s] = (counts[s] == 0) ? 0 : std::max<uint32_t>(1, counts[s] * TotalFrequency / total);
+        sum += frequencies[s];
+    }
+
+    // The most frequent symbol absorbs the rounding error
+    while (sum != TotalFrequency) {
+        uint32_t *largest = std::max_element(frequencies, frequencies + 256);
+
+        if (sum < TotalFrequency) {
+            *largest += TotalFrequency - sum;
+            sum = TotalFrequency;
+        } else {
+            uint32_t excess = std::min(sum - TotalFrequency, *largest - 1);
+            *largest -= excess;
+            sum -= excess;
+        }
+    }
+}
+
+// The division by the frequency is a multiplication by its reciprocal,
+// exact for states below 2^31
+struct EncodeSymbol {
+    uint32_t limit;
+    uint32_t reciprocal;
+    uint32_t bias;
+    uint16_t complement;
+    uint16_t shift;
+};
+
+static EncodeSymbol makeEncodeSymbol(uint32_t start, uint32_t frequency)
+{
+    EncodeSymbol symbol;
+    symbol.limit = ((LowerBound >> ScaleBits) << 16) * frequency;
+    symbol.complement = static_cast<uint16_t>(TotalFrequency - frequency);
+
+    if (frequency < 2) {
+        symbol.reciprocal = UINT32_MAX;
+        symbol.shift = 0;
+        symbol.bias = start + TotalFrequency - 1;
+    } else {
+        uint32_t shift = 0;
+
+        while (frequency > (1u << shift)) {
+            shift++;
+        }
+
+        symbol.reciprocal = static_cast<uint32_t>(((uint64_t(1) << (shift + 31)) + frequency - 1) / frequency);
+        symbol.shift = static_cast<uint16_t>(shift - 1);
+        symbol.bias = start;
+    }
+
+    return symbol;
+}
+
+static inline void encodeSymbol(uint32_t &state, uint8_t *&output, const EncodeSymbol &symbol)
+{
+    // Branchless renormalization, the word is always stored but only kept
+    // when the state has to shrink
+    uint32_t renormalize = state >= symbol.limit;
+    output[-2] = static_cast<uint8_t>(state);
+    output[-1] = static_cast<uint8_t>(state >> 8);
+    output -= renormalize * 2;
+    state >>= renormalize * 16;
+
+    uint32_t quotient = static_cast<uint32_t>((static_cast<uint64_t>(state) * symbol.reciprocal) >> 32) >> symbol.shift;
+    state += symbol.bias + quotient * symbol.complement;
+}
+
+void RANSCoder::encodeBlock(const uint8_t *data, uint32_t size, std::vector<uint8_t> &output)
+{
+    uint64_t counts[256] = {};
+
+    for (uint32_t i = 0; i < size; ++i) {
+        counts[data[i]]++;
+    }
+
+    uint32_t frequencies[256];
+    EncodeSymbol symbols[256];
+    normalizeFrequencies(counts, size, frequencies);
+
+    for (unsigned s = 0, start = 0; s < 256; ++s) {
+        symbols[s] = makeEncodeSymbol(start, frequencies[s]);
+        start += frequencies[s];
+    }
+
+    // rANS codes backwards, so the payload is built from the end of a
+    // buffer which holds 16 bits per symbol and the final states
+    std::vector<uint8_t> buffer(static_cast<size_t>(size) * 2 + StreamCount * 4 + 16);
+    uint8_t *end = buffer.data() + buffer.size();
+    uint8_t *ptr = end;
+    uint32_t states[StreamCount] = { LowerBound, LowerBound, LowerBound, LowerBound };
+
+    uint32_t i = size;
+
+    for (; i % StreamCount != 0; --i) {
+        encodeSymbol(states[(i - 1) % StreamCount], ptr, symbols[data[i - 1]]);
+    }
+
+    for (; i > 0; i -= StreamCount) {
+        encodeSymbol(states[3], ptr, symbols[data[i - 1]]);
+        encodeSymbol(states[2], ptr, symbols[data[i - 2]]);
+        encodeSymbol(states[1], ptr, symbols[data[i - 3]]);
+        encodeSymbol(states[0], ptr, symbols[data[i - 4]]);
+    }
+
+    for (unsigned k = StreamCount; k-- > 0;) {
+        ptr -= 4;
+
+        for (unsigned i = 0; i < 4; ++i) {
+            ptr[i] = static_cast<uint8_t>(states[k] >> (i * 8));
+        }
+    }
+
+    putUint32(output, size);
+    putUint32(output, static_cast<uint32_t>(end - ptr));
+
+    uint8_t symbolMap[SymbolMapSize] = {};
+
+    for (unsigned s = 0; s < 256; ++s) {
+        if (frequencies[s] != 0) {
+            symbolMap[s / 8] |= static_cast<uint8_t>(1 << (s % 8));
+        }
+    }
+
+    output.insert(output.end(), symbolMap, symbolMap + SymbolMapSize);
+
+    for (unsigned s = 0; s < 256; ++s) {
+        if (frequencies[s] != 0) {
+            output.push_back(static_cast<uint8_t>(frequencies[s]));
+            output.push_back(static_cast<uint8_t>(frequencies[s] >> 8));
+        }
+    }
+
+    output.insert(output.end(), ptr, end);
+}
+
+void RANSCoder::decodeBlock(const ByteView &input, size_t &pos, std::vector<uint8_t> &output)
+{
+    if (input.size() - pos < BlockHeaderSize + SymbolMapSize) {
+        throw std::runtime_error("rANS block is truncated!");
+    }
+
+    uint32_t size = getUint32(input.data() + pos);
+    uint32_t codedSize = getUint32(input.data() + pos + 4);
+    const uint8_t *symbolMap = input.data() + pos + BlockHeaderSize;
+    pos += BlockHeaderSize + SymbolMapSize;
+
+    // Each slot holds its symbol, the symbol frequency minus one and the
+    // slot offset from the symbol start
+    uint32_t slots[TotalFrequency];
+    uint32_t start = 0;
+
+    for (unsigned s = 0; s < 256; ++s) {
+        if (!(symbolMap[s / 8] & (1 << (s % 8)))) {
+            continue;
+        }
+
+        if (input.size() - pos < 2) {
+            throw std::runtime_error("rANS block is truncated!");
+        }
+
+        uint32_t frequency = input[pos] | (input[pos + 1] << 8);
+        pos += 2;
+
+        if (frequency == 0 || frequency > TotalFrequency - start) {
+            throw std::runtime_error("Invalid rANS frequencies!");
+        }
+
+        for (uint32_t offset = 0; offset < frequency; ++offset) {
+            slots[start + offset] = s | ((frequency - 1) << 8) | (offset << 20);
+        }
+
+        start += frequency;
+    }
+
+    if ((start != TotalFrequency && size != 0) || codedSize < StreamCount * 4 || input.size() - pos < codedSize) {
+        throw std::runtime_error("Invalid rANS block!");
+    }
+
+    const uint8_t *ptr = input.data() + pos;
+    const uint8_t *end = ptr + codedSize;
+    uint32_t states[StreamCount];
+
+    for (unsigned k = 0; k < StreamCount; ++k, ptr += 4) {
+        states[k] = getUint32(ptr);
+    }
+
+    size_t outputStart = output.size();
+    output.resize(outputStart + size);
+    uint8_t *decoded = output.data() + outputStart;
+
+    // Four symbols read at most four words, so the checks are only needed
+    // near the end of the payload
+    auto advance = [&slots](uint32_t &state) {
+        uint32_t slot = slots[state & SlotMask];
+        state = (((slot >> 8) & SlotMask) + 1) * (state >> ScaleBits) + (slot >> 20);
+        return static_cast<uint8_t>(slot);
+    };
+
+    auto decodeSymbol = [&](uint32_t &state) {
+        uint8_t symbol = advance(state);
+        uint32_t renormalize = state < LowerBound;
+        uint32_t word = (ptr[0] | (ptr[1] << 8)) & (0u - renormalize);
+        state = (state << (renormalize * 16)) | word;
+        ptr += renormalize * 2;
+        return symbol;
+    };
+
+    auto decodeCheckedSymbol = [&](uint32_t &state) {
+        uint8_t symbol = advance(state);
+
+        if (state < LowerBound) {
+            if (end - ptr < 2) {
+                throw std::runtime_error("rANS block is truncated!");
+            }
+
+            state = (state << 16) | ptr[0] | (ptr[1] << 8);
+            ptr += 2;
+        }
+
+        return symbol;
+    };
+
+    uint32_t i = 0;
+
+    // The four states are independent, so their decodes overlap
+    for (; i + StreamCount <= size && end - ptr >= 8; i += StreamCount) {
+        decoded[i] = decodeSymbol(states[0]);
+        decoded[i + 1] = decodeSymbol(states[1]);
+        decoded[i + 2] = decodeSymbol(states[2]);
+        decoded[i + 3] = decodeSymbol(states[3]);
+    }
+
+    for (; i < size; ++i) {
+        decoded[i] = decodeCheckedSymbol(states[i % StreamCount]);
+    }
+
+    pos += codedSize;
+}
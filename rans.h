@@ -0,0 +1,31 @@
+/******************************************************************************
+ * File Name    : rans.h
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Four Way Interleaved Order-0 rANS Entropy Coder
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#ifndef RANS_H
+#define RANS_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "byteview.h"
+
+class RANSCoder
+{
+public:
+    // A block is its raw size, its coded size, the symbol frequencies
+    // normalized to 12 bits and the four final states followed by the
+    // renormalization bytes. Symbol i is coded by state i % 4.
+    static void encodeBlock(const uint8_t *data, uint32_t size, std::vector<uint8_t> &output);
+
+    // Decodes the block at input[pos], appends it to output and moves pos
+    // behind it. Throws on malformed blocks.
+    static void decodeBlock(const ByteView &input, size_t &pos, std::vector<uint8_t> &output);
+};
+
+#endif // RANS_H
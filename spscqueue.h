@@ -0,0 +1,154 @@
+/******************************************************************************
+ * File Name    : spscqueue.h
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Bounded Lock-Free Single Producer Single Consumer Queue
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+template <typename T>
+class SPSCQueue
+{
+public:
+    // The capacity is rounded up to a power of two
+    explicit SPSCQueue(size_t capacity) : m_head(0), m_tail(0), m_waiters(0), m_cancelled(false)
+    {
+        size_t size = 1;
+
+        while (size < capacity) {
+            size <<= 1;
+        }
+
+        m_slots.resize(size);
+        m_mask = size - 1;
+    }
+
+    SPSCQueue(const SPSCQueue &) = delete;
+    SPSCQueue &operator=(const SPSCQueue &) = delete;
+
+    // Only the producer thread may push, the value is moved in on success
+    bool tryPush(T &value)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+
+        if (tail - m_head.load(std::memory_order_acquire) > m_mask) {
+            return false;
+        }
+
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Only the consumer thread may pop
+    bool tryPop(T &value)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        value = std::move(m_slots[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Blocking forms of tryPush and tryPop. They spin for a while and then
+    // sleep until the other side moves. Both return false once the queue is
+    // cancelled.
+    bool push(T &value)
+    {
+        return waitFor([this, &value]() {
+            return tryPush(value);
+        });
+    }
+
+    bool pop(T &value)
+    {
+        return waitFor([this, &value]() {
+            return tryPop(value);
+        });
+    }
+
+    // Wakes both sides for good, may be called from any thread
+    void cancel()
+    {
+        m_cancelled.store(true);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_changed.notify_all();
+    }
+
+private:
+    static const unsigned SpinCount = 64;
+
+    template <typename Step>
+    bool waitFor(const Step &step)
+    {
+        for (unsigned spin = 0; !step(); ++spin) {
+            if (m_cancelled.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            if (spin < SpinCount) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // The other side checks for waiters after it moves an index, the
+            // step is tried again under the mutex so no wake up is missed
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_waiters.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool done = false;
+
+            m_changed.wait(lock, [&]() {
+                done = step();
+                return done || m_cancelled.load();
+            });
+
+            m_waiters.fetch_sub(1);
+
+            if (done) {
+                break;
+            }
+        }
+
+        wakeWaiters();
+        return true;
+    }
+
+    void wakeWaiters()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (m_waiters.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_changed.notify_all();
+        }
+    }
+
+    std::vector<T> m_slots;
+    size_t m_mask;
+    // The indices only grow, each one is written by a single thread and sits
+    // on its own cache line
+    alignas(64) std::atomic<size_t> m_head;
+    alignas(64) std::atomic<size_t> m_tail;
+    alignas(64) std::atomic<unsigned> m_waiters;
+    std::atomic<bool> m_cancelled;
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+};
+
+#endif // SPSCQUEUE_H
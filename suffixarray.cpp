@@ -0,0 +1,187 @@
+/******************************************************************************
+ * File Name    : suffixarray.cpp
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Linear Time Suffix Array Construction (SA-IS)
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#include "suffixarray.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+template <typename Char, typename Index>
+static void getBuckets(const Char *text, Index length, Index alphabetSize, Index *buckets, bool end)
+{
+    std::fill(buckets, buckets + alphabetSize, 0);
+
+    for (Index i = 0; i < length; ++i) {
+        buckets[text[i]]++;
+    }
+
+    Index sum = 0;
+
+    for (Index c = 0; c < alphabetSize; ++c) {
+        sum += buckets[c];
+        buckets[c] = end ? sum : sum - buckets[c];
+    }
+}
+
+template <typename Char, typename Index>
+static void induceSort(const Char *text, Index *sa, Index length, Index alphabetSize,
+                       const std::vector<bool> &types, Index *buckets)
+{
+    getBuckets(text, length, alphabetSize, buckets, false);
+
+    // The last suffix is L-type and follows the virtual sentinel
+    sa[buckets[text[length - 1]]++] = length - 1;
+
+    for (Index i = 0; i < length; ++i) {
+        Index j = sa[i] - 1;
+
+        if (sa[i] > 0 && !types[j]) {
+            sa[buckets[text[j]]++] = j;
+        }
+    }
+
+    getBuckets(text, length, alphabetSize, buckets, true);
+
+    for (Index i = length; i-- > 0;) {
+        Index j = sa[i] - 1;
+
+        if (sa[i] > 0 && types[j]) {
+            sa[--buckets[text[j]]] = j;
+        }
+    }
+}
+
+template <typename Char, typename Index>
+static void sais(const Char *text, Index *sa, Index length, Index alphabetSize)
+{
+    if (length == 0) {
+        return;
+    }
+
+    if (length == 1) {
+        sa[0] = 0;
+        return;
+    }
+
+    std::vector<bool> types(length, false);
+
+    for (Index i = length - 1; i-- > 0;) {
+        types[i] = text[i] < text[i + 1] || (text[i] == text[i + 1] && types[i + 1]);
+    }
+
+    auto isLMS = [&types](Index i) {
+        return i > 0 && types[i] && !types[i - 1];
+    };
+
+    std::vector<Index> buckets(alphabetSize);
+
+    getBuckets(text, length, alphabetSize, buckets.data(), true);
+    std::fill(sa, sa + length, -1);
+
+    for (Index i = 1; i < length; ++i) {
+        if (isLMS(i)) {
+            sa[--buckets[text[i]]] = i;
+        }
+    }
+
+    induceSort(text, sa, length, alphabetSize, types, buckets.data());
+
+    Index lmsCount = 0;
+
+    for (Index i = 0; i < length; ++i) {
+        if (isLMS(sa[i])) {
+            sa[lmsCount++] = sa[i];
+        }
+    }
+
+    std::fill(sa + lmsCount, sa + length, -1);
+
+    Index nameCount = 0;
+    Index previous = -1;
+
+    for (Index i = 0; i < lmsCount; ++i) {
+        Index position = sa[i];
+        bool differ = previous < 0;
+
+        for (Index d = 0; !differ; ++d) {
+            if (position + d == length || previous + d == length
+                || text[position + d] != text[previous + d]
+                || types[position + d] != types[previous + d]) {
+                differ = true;
+            } else if (d > 0 && isLMS(position + d)) {
+                break;
+            }
+        }
+
+        if (differ) {
+            ++nameCount;
+        }
+
+        previous = position;
+        sa[lmsCount + position / 2] = nameCount - 1;
+    }
+
+    for (Index i = length, j = length; i-- > lmsCount;) {
+        if (sa[i] >= 0) {
+            sa[--j] = sa[i];
+        }
+    }
+
+    Index *reduced = sa + length - lmsCount;
+
+    if (nameCount < lmsCount) {
+        sais<Index, Index>(reduced, sa, lmsCount, nameCount);
+    } else {
+        for (Index i = 0; i < lmsCount; ++i) {
+            sa[reduced[i]] = i;
+        }
+    }
+
+    for (Index i = 1, j = 0; i < length; ++i) {
+        if (isLMS(i)) {
+            reduced[j++] = i;
+        }
+    }
+
+    for (Index i = 0; i < lmsCount; ++i) {
+        sa[i] = reduced[sa[i]];
+    }
+
+    std::fill(sa + lmsCount, sa + length, -1);
+    getBuckets(text, length, alphabetSize, buckets.data(), true);
+
+    for (Index i = lmsCount; i-- > 0;) {
+        Index j = sa[i];
+        sa[i] = -1;
+        sa[--buckets[text[j]]] = j;
+    }
+
+    induceSort(text, sa, length, alphabetSize, types, buckets.data());
+}
+
+template <typename Index>
+static void buildSuffixArray(const uint8_t *text, size_t length, std::vector<Index> &suffixArray)
+{
+    if (length >= static_cast<size_t>(std::numeric_limits<Index>::max())) {
+        throw std::runtime_error("Text is too large for suffix array!");
+    }
+
+    suffixArray.resize(length);
+    sais<uint8_t, Index>(text, suffixArray.data(), static_cast<Index>(length), 256);
+}
+
+void SuffixArray::build(const uint8_t *text, size_t length, std::vector<int32_t> &suffixArray)
+{
+    buildSuffixArray(text, length, suffixArray);
+}
+
+void SuffixArray::build(const uint8_t *text, size_t length, std::vector<int64_t> &suffixArray)
+{
+    buildSuffixArray(text, length, suffixArray);
+}
@@ -0,0 +1,25 @@
+/******************************************************************************
+ * File Name    : suffixarray.h
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Linear Time Suffix Array Construction (SA-IS)
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#ifndef SUFFIXARRAY_H
+#define SUFFIXARRAY_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class SuffixArray
+{
+public:
+    // Suffixes are ordered as if the text was followed by a unique smallest
+    // sentinel, so a suffix which is a prefix of another one comes first.
+    static void build(const uint8_t *text, size_t length, std::vector<int32_t> &suffixArray);
+    static void build(const uint8_t *text, size_t length, std::vector<int64_t> &suffixArray);
+};
+
+#endif // SUFFIXARRAY_H
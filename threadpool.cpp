@@ -0,0 +1,129 @@
+/******************************************************************************
+ * File Name    : threadpool.cpp
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Fixed Size Worker Thread Pool
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#include "threadpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+ThreadPool::ThreadPool(unsigned threadCount) : m_stopping(false)
+{
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_condition.notify_all();
+
+    for (std::thread &worker : m_workers) {
+        worker.join();
+    }
+}
+
+unsigned ThreadPool::threadCount() const
+{
+    return static_cast<unsigned>(m_workers.size());
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)> &task)
+{
+    if (count == 0) {
+        return;
+    }
+
+    if (count == 1 || m_workers.size() == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+    size_t jobCount = std::min(count, m_workers.size());
+    size_t running = jobCount;
+
+    auto job = [&]() {
+        for (size_t i = next++; i < count; i = next++) {
+            try {
+                task(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(doneMutex);
+
+                if (!error) {
+                    error = std::current_exception();
+                }
+
+                next = count;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(doneMutex);
+
+        if (--running == 0) {
+            doneCondition.notify_one();
+        }
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (size_t i = 0; i < jobCount; ++i) {
+            m_tasks.push(job);
+        }
+    }
+
+    m_condition.notify_all();
+
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneCondition.wait(lock, [&running]() {
+        return running == 0;
+    });
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() {
+                return m_stopping || !m_tasks.empty();
+            });
+
+            if (m_tasks.empty()) {
+                return;
+            }
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+
+        task();
+    }
+}
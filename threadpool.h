@@ -0,0 +1,45 @@
+/******************************************************************************
+ * File Name    : threadpool.h
+ * Coder        : Aziz Gökhan NARİN
+ * E-Mail       : azizgokhannarin@yahoo.com
+ * Explanation  : Fixed Size Worker Thread Pool
+ * Versiyon     : 1.0.0
+ ******************************************************************************/
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+class ThreadPool
+{
+public:
+    // A thread count of zero uses every hardware thread
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned threadCount() const;
+
+    // Runs task(0) ... task(count - 1) on the workers and waits for all of
+    // them. The first exception thrown by a task is rethrown here.
+    void parallelFor(size_t count, const std::function<void(size_t)> &task);
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping;
+};
+
+#endif // THREADPOOL_H
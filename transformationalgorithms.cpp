@@ -7,10 +7,19 @@
  ******************************************************************************/
 
 #include "transformationalgorithms.h"
+#include "suffixarray.h"
+#include "threadpool.h"
+#include "fileio.h"
 
+#include <algorithm>
 #include <bitset>
+#include <cstring>
 #include <iostream>
-#include <fstream>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 struct pair_hash {
     std::size_t operator()(const std::pair<uint8_t, uint8_t> &pair) const
@@ -19,6 +28,535 @@ struct pair_hash {
     }
 };
 
+static const uint8_t BlockedBWTMagic[4] = { 'B', 'W', 'T', 'B' };
+static const size_t MaxBWTStreams = 8;
+static const size_t BlockedBWTStreams = 4;
+static const size_t BlockedBWTHeaderSize = (1 + BlockedBWTStreams) * sizeof(uint32_t);
+
+// Stride delta data starts with a magic, the 32-bit stride and the order
+static const uint8_t StrideDeltaMagic[4] = { 'D', 'L', 'T', 'S' };
+static const size_t StrideDeltaHeaderSize = 9;
+
+// Threshold RLE writes runs as four bytes and a count of further repeats
+static const size_t RLERunThreshold = 4;
+static const size_t RLEMaxRun = RLERunThreshold + 255;
+
+static void putUint32(uint8_t *buffer, uint32_t value)
+{
+    buffer[0] = static_cast<uint8_t>(value & 0xFF);
+    buffer[1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+    buffer[2] = static_cast<uint8_t>((value >> 16) & 0xFF);
+    buffer[3] = static_cast<uint8_t>((value >> 24) & 0xFF);
+}
+
+static uint32_t getUint32(const uint8_t *buffer)
+{
+    return static_cast<uint32_t>(buffer[0])
+           | (static_cast<uint32_t>(buffer[1]) << 8)
+           | (static_cast<uint32_t>(buffer[2]) << 16)
+           | (static_cast<uint32_t>(buffer[3]) << 24);
+}
+
+// Length of the run of data[0] at the start of data
+static inline size_t runLength(const uint8_t *data, size_t size)
+{
+    size_t run = 1;
+
+#if defined(__SSE2__)
+    __m128i needle = _mm_set1_epi8(static_cast<char>(data[0]));
+
+    while (run + 16 <= size) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + run));
+        int equal = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, needle));
+
+        if (equal != 0xFFFF) {
+            return run + __builtin_ctz(~equal);
+        }
+
+        run += 16;
+    }
+#endif
+
+    while (run < size && data[run] == data[0]) {
+        ++run;
+    }
+
+    return run;
+}
+
+// First position where four equal bytes start, size when there is none
+static inline size_t findRunStart(const uint8_t *data, size_t size)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 19 <= size; i += 16) {
+        __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 1));
+        __m128i third = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 2));
+        __m128i fourth = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 3));
+        __m128i equal = _mm_and_si128(_mm_cmpeq_epi8(first, second),
+                                      _mm_and_si128(_mm_cmpeq_epi8(first, third), _mm_cmpeq_epi8(first, fourth)));
+        int mask = _mm_movemask_epi8(equal);
+
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    for (; i + 3 < size; ++i) {
+        if (data[i] == data[i + 1] && data[i] == data[i + 2] && data[i] == data[i + 3]) {
+            return i;
+        }
+    }
+
+    return size;
+}
+
+#if defined(__SSE2__)
+// The first 16 MTF entries stay in a register, table keeps the rest
+
+// Moves symbol to the front, the first count entries shift back by one
+static inline __m128i pushMTFHead(__m128i head, size_t count, uint8_t symbol)
+{
+    __m128i lanes = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m128i moved = _mm_cmplt_epi8(lanes, _mm_set1_epi8(static_cast<char>(count)));
+    __m128i shifted = _mm_slli_si128(head, 1);
+    head = _mm_or_si128(_mm_and_si128(moved, shifted), _mm_andnot_si128(moved, head));
+    return _mm_or_si128(head, _mm_cvtsi32_si128(symbol));
+}
+
+// Moves table[index] behind the head and the last head entry into memory
+static inline void spillMTFHead(uint8_t *table, __m128i head, size_t index)
+{
+    std::memmove(table + 17, table + 16, index - 16);
+    table[16] = static_cast<uint8_t>(_mm_extract_epi16(head, 7) >> 8);
+}
+
+static void encodeMTF(uint8_t *table, uint8_t *data, size_t size)
+{
+    __m128i head = _mm_load_si128(reinterpret_cast<const __m128i *>(table));
+
+    for (size_t i = 0; i < size; ++i) {
+        uint8_t symbol = data[i];
+        __m128i needle = _mm_set1_epi8(static_cast<char>(symbol));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(head, needle));
+
+        // After BWT most symbols are already at the front, their runs turn
+        // into runs of zero
+        if (mask & 1) {
+            size_t run = runLength(data + i, size - i);
+            std::memset(data + i, 0, run);
+            i += run - 1;
+            continue;
+        }
+
+        size_t index;
+
+        if (mask != 0) {
+            index = __builtin_ctz(mask);
+        } else {
+            index = 16;
+
+            for (;; index += 16) {
+                __m128i entries = _mm_load_si128(reinterpret_cast<const __m128i *>(table + index));
+                mask = _mm_movemask_epi8(_mm_cmpeq_epi8(entries, needle));
+
+                if (mask != 0) {
+                    index += __builtin_ctz(mask);
+                    break;
+                }
+            }
+
+            spillMTFHead(table, head, index);
+        }
+
+        head = pushMTFHead(head, std::min<size_t>(index + 1, 16), symbol);
+        data[i] = static_cast<uint8_t>(index);
+    }
+
+    _mm_store_si128(reinterpret_cast<__m128i *>(table), head);
+}
+
+static void decodeMTF(uint8_t *table, uint8_t *data, size_t size)
+{
+    __m128i head = _mm_load_si128(reinterpret_cast<const __m128i *>(table));
+
+    for (size_t i = 0; i < size; ++i) {
+        size_t index = data[i];
+        uint8_t symbol;
+
+        if (index == 0) {
+            size_t run = runLength(data + i, size - i);
+            std::memset(data + i, _mm_cvtsi128_si32(head) & 0xFF, run);
+            i += run - 1;
+            continue;
+        }
+
+        if (index < 16) {
+            alignas(16) uint8_t entries[16];
+            _mm_store_si128(reinterpret_cast<__m128i *>(entries), head);
+            symbol = entries[index];
+        } else {
+            symbol = table[index];
+            spillMTFHead(table, head, index);
+        }
+
+        head = pushMTFHead(head, std::min<size_t>(index + 1, 16), symbol);
+        data[i] = symbol;
+    }
+
+    _mm_store_si128(reinterpret_cast<__m128i *>(table), head);
+}
+#else
+static void encodeMTF(uint8_t *table, uint8_t *data, size_t size)
+{
+    for (size_t i = 0; i < size; ++i) {
+        uint8_t symbol = data[i];
+
+        if (table[0] == symbol) {
+            data[i] = 0;
+        } else if (table[1] == symbol) {
+            std::swap(table[0], table[1]);
+            data[i] = 1;
+        } else {
+            size_t index = std::find(table + 2, table + 256, symbol) - table;
+            std::memmove(table + 1, table, index);
+            table[0] = symbol;
+            data[i] = static_cast<uint8_t>(index);
+        }
+    }
+}
+
+static void decodeMTF(uint8_t *table, uint8_t *data, size_t size)
+{
+    for (size_t i = 0; i < size; ++i) {
+        size_t index = data[i];
+        uint8_t symbol = table[index];
+
+        if (index == 1) {
+            std::swap(table[0], table[1]);
+        } else if (index > 1) {
+            std::memmove(table + 1, table, index);
+            table[0] = symbol;
+        }
+
+        data[i] = symbol;
+    }
+}
+#endif
+
+// data[i] -= data[i - stride], walking backwards so every source byte is
+// read before it changes
+static void encodeStrideDelta(uint8_t *data, size_t size, size_t stride)
+{
+    if (size <= stride) {
+        return;
+    }
+
+    size_t i = size;
+
+#if defined(__SSE2__)
+    while (i >= stride + 16) {
+        i -= 16;
+        __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i - stride));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(data + i), _mm_sub_epi8(current, previous));
+    }
+#endif
+
+    while (i-- > stride) {
+        data[i] -= data[i - stride];
+    }
+}
+
+#if defined(__SSE2__)
+// Running sums over every Stride-th byte of 16 byte blocks. Sums inside a
+// block take doubling shifts, the last Stride sums of a block carry over
+// to all lanes of the next one. Returns where the scalar tail starts.
+template <size_t Stride>
+static size_t decodeStrideDeltaBlocks(uint8_t *data, size_t size)
+{
+    __m128i carry = _mm_setzero_si128();
+    size_t i = 0;
+
+    for (; i + 16 <= size; i += 16) {
+        __m128i sum = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+
+        if (Stride <= 1) {
+            sum = _mm_add_epi8(sum, _mm_slli_si128(sum, 1));
+        }
+
+        if (Stride <= 2) {
+            sum = _mm_add_epi8(sum, _mm_slli_si128(sum, 2));
+        }
+
+        if (Stride <= 4) {
+            sum = _mm_add_epi8(sum, _mm_slli_si128(sum, 4));
+        }
+
+        sum = _mm_add_epi8(_mm_add_epi8(sum, _mm_slli_si128(sum, 8)), carry);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(data + i), sum);
+
+        if (Stride == 1) {
+            carry = _mm_shuffle_epi32(_mm_shufflehi_epi16(_mm_unpackhi_epi8(sum, sum), 0xFF), 0xFF);
+        } else if (Stride == 2) {
+            carry = _mm_shuffle_epi32(_mm_shufflehi_epi16(sum, 0xFF), 0xFF);
+        } else if (Stride == 4) {
+            carry = _mm_shuffle_epi32(sum, 0xFF);
+        } else {
+            carry = _mm_unpackhi_epi64(sum, sum);
+        }
+    }
+
+    return i;
+}
+#endif
+
+// data[i] += data[i - stride] as a running sum
+static void decodeStrideDelta(uint8_t *data, size_t size, size_t stride)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    switch (stride) {
+    case 1:
+        i = decodeStrideDeltaBlocks<1>(data, size);
+        break;
+    case 2:
+        i = decodeStrideDeltaBlocks<2>(data, size);
+        break;
+    case 4:
+        i = decodeStrideDeltaBlocks<4>(data, size);
+        break;
+    case 8:
+        i = decodeStrideDeltaBlocks<8>(data, size);
+        break;
+    default:
+        // Blocks never overlap their source once the stride spans a block
+        if (stride >= 16) {
+            for (i = stride; i + 16 <= size; i += 16) {
+                __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+                __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i - stride));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(data + i), _mm_add_epi8(current, previous));
+            }
+        }
+        break;
+    }
+#endif
+
+    for (i = std::max(i, stride); i < size; ++i) {
+        data[i] += data[i - stride];
+    }
+}
+
+static size_t minimalRotation(const uint8_t *data, size_t len)
+{
+    size_t i = 0;
+    size_t j = 1;
+    size_t k = 0;
+
+    while (i < len && j < len && k < len) {
+        size_t a = i + k;
+        size_t b = j + k;
+        uint8_t ac = data[a < len ? a : a - len];
+        uint8_t bc = data[b < len ? b : b - len];
+
+        if (ac == bc) {
+            ++k;
+            continue;
+        }
+
+        if (ac > bc) {
+            i += k + 1;
+        } else {
+            j += k + 1;
+        }
+
+        if (i == j) {
+            ++j;
+        }
+
+        k = 0;
+    }
+
+    return std::min(i, j);
+}
+
+static size_t lyndonRootLength(const uint8_t *data, size_t len)
+{
+    size_t j = 1;
+    size_t k = 0;
+
+    while (j < len && data[k] <= data[j]) {
+        k = (data[k] < data[j]) ? 0 : k + 1;
+        ++j;
+    }
+
+    return j - k;
+}
+
+// First position of a stream when a block is split into streamCount parts
+static size_t streamStart(size_t len, size_t stream, size_t streamCount)
+{
+    return len * stream / streamCount;
+}
+
+static size_t blockedBWTSize(size_t size, size_t blockSize)
+{
+    return size + (size + blockSize - 1) / blockSize * BlockedBWTHeaderSize;
+}
+
+static std::vector<size_t> scanBlockedBWT(const uint8_t *encodedData, size_t size, size_t &decodedSize)
+{
+    std::vector<size_t> blockOffsets;
+    decodedSize = 0;
+
+    for (size_t offset = 0; offset < size;) {
+        if (size - offset < BlockedBWTHeaderSize) {
+            throw std::runtime_error("Data format is wrong!");
+        }
+
+        size_t len = getUint32(encodedData + offset);
+
+        if (len == 0 || size - offset - BlockedBWTHeaderSize < len) {
+            throw std::runtime_error("Data format is wrong!");
+        }
+
+        for (size_t stream = 0; stream < BlockedBWTStreams; ++stream) {
+            if (getUint32(encodedData + offset + (1 + stream) * sizeof(uint32_t)) >= len) {
+                throw std::runtime_error("Data format is wrong!");
+            }
+        }
+
+        blockOffsets.push_back(offset);
+        offset += BlockedBWTHeaderSize + len;
+        decodedSize += len;
+    }
+
+    return blockOffsets;
+}
+
+// Rotating the block to its minimal rotation turns it into a power of a
+// Lyndon word, whose rotations are ordered exactly like its suffixes. So the
+// rotation sort reduces to a linear time suffix array of the Lyndon root.
+template <typename Index>
+static void sortRotations(const uint8_t *block, size_t len, uint8_t *lastColumn, size_t *startRows,
+                          size_t streamCount)
+{
+    size_t shift = minimalRotation(block, len);
+    std::vector<uint8_t> rotated(len);
+    std::copy(block + shift, block + len, rotated.begin());
+    std::copy(block, block + shift, rotated.begin() + (len - shift));
+
+    size_t rootLen = lyndonRootLength(rotated.data(), len);
+    size_t copies = len / rootLen;
+    size_t startRotations[MaxBWTStreams];
+
+    for (size_t stream = 0; stream < streamCount; ++stream) {
+        size_t start = streamStart(len, stream, streamCount);
+        startRotations[stream] = ((start + len - shift) % len) % rootLen;
+    }
+
+    std::vector<Index> suffixArray;
+    SuffixArray::build(rotated.data(), rootLen, suffixArray);
+
+    for (size_t i = 0; i < rootLen; ++i) {
+        size_t start = static_cast<size_t>(suffixArray[i]);
+        uint8_t symbol = rotated[(start == 0) ? rootLen - 1 : start - 1];
+        std::fill(lastColumn + i * copies, lastColumn + (i + 1) * copies, symbol);
+
+        for (size_t stream = 0; stream < streamCount; ++stream) {
+            if (start == startRotations[stream]) {
+                startRows[stream] = i * copies;
+            }
+        }
+    }
+}
+
+// Every entry packs the symbol of a row into its low byte and the row of the
+// next rotation above it, so a step costs one random access. The streams
+// start at different rows and are walked together, so their cache misses
+// overlap instead of serializing.
+template <typename Entry>
+static void inverseRotations(const uint8_t *lastColumn, size_t len, const size_t *startRows, size_t streamCount,
+                             uint8_t *block)
+{
+    size_t cumulativeCount[256] = {};
+
+    for (size_t i = 0; i < len; ++i) {
+        cumulativeCount[lastColumn[i]]++;
+    }
+
+    for (size_t i = 0, sum = 0; i < 256; ++i) {
+        size_t count = cumulativeCount[i];
+        cumulativeCount[i] = sum;
+        sum += count;
+    }
+
+    std::vector<Entry> rows(len);
+
+    for (size_t i = 0; i < len; ++i) {
+        size_t row = cumulativeCount[lastColumn[i]]++;
+        rows[row] = (static_cast<Entry>(i) << 8) | lastColumn[row];
+    }
+
+    Entry entries[MaxBWTStreams];
+    uint8_t *outputs[MaxBWTStreams];
+
+    for (size_t stream = 0; stream < streamCount; ++stream) {
+        entries[stream] = rows[startRows[stream]];
+        outputs[stream] = block + streamStart(len, stream, streamCount);
+    }
+
+    size_t steps = len / streamCount;
+
+    for (size_t i = 0; i < steps; ++i) {
+        for (size_t stream = 0; stream < streamCount; ++stream) {
+            entries[stream] = rows[static_cast<size_t>(entries[stream] >> 8)];
+            *outputs[stream]++ = static_cast<uint8_t>(entries[stream]);
+        }
+    }
+
+    for (size_t stream = 0; stream < streamCount; ++stream) {
+        uint8_t *end = block + streamStart(len, stream + 1, streamCount);
+
+        while (outputs[stream] < end) {
+            entries[stream] = rows[static_cast<size_t>(entries[stream] >> 8)];
+            *outputs[stream]++ = static_cast<uint8_t>(entries[stream]);
+        }
+    }
+}
+
+void TransformationAlgorithms::encodeBlockWithBWT(const uint8_t *block, size_t len, uint8_t *lastColumn,
+        size_t *startRows, size_t streamCount)
+{
+    if (streamCount == 0 || streamCount > MaxBWTStreams) {
+        throw std::runtime_error("Invalid BWT stream count!");
+    }
+
+    if (len < static_cast<size_t>(INT32_MAX)) {
+        sortRotations<int32_t>(block, len, lastColumn, startRows, streamCount);
+    } else {
+        sortRotations<int64_t>(block, len, lastColumn, startRows, streamCount);
+    }
+}
+
+void TransformationAlgorithms::decodeBlockWithBWT(const uint8_t *lastColumn, size_t len, const size_t *startRows,
+        size_t streamCount, uint8_t *block)
+{
+    if (streamCount == 0 || streamCount > MaxBWTStreams) {
+        throw std::runtime_error("Invalid BWT stream count!");
+    }
+
+    if (len < (static_cast<size_t>(1) << 24)) {
+        inverseRotations<uint32_t>(lastColumn, len, startRows, streamCount, block);
+    } else {
+        inverseRotations<uint64_t>(lastColumn, len, startRows, streamCount, block);
+    }
+}
+
 TransformationAlgorithms::TransformationAlgorithms()
 {
 
@@ -32,25 +570,23 @@ TransformationAlgorithms::~TransformationAlgorithms()
 bool TransformationAlgorithms::encodeFile(const std::string &inputFileName, const std::string &outputFileName,
         std::function<void(std::vector<uint8_t> &data)> encodeAlgorithm)
 {
-    std::ifstream inputFile(inputFileName, std::ios::binary);
+    FileReader inputFile(inputFileName);
 
-    if (!inputFile) {
+    if (!inputFile.isOpen()) {
         return false;
     }
 
-    std::vector<uint8_t> inputData((std::istreambuf_iterator<char>(inputFile)),
-                                   std::istreambuf_iterator<char>());
-    inputFile.close();
-
     try {
+        std::vector<uint8_t> inputData;
+        inputFile.readAll(inputData);
         encodeAlgorithm(inputData);
-        std::ofstream outputFile(outputFileName, std::ios::binary);
+        FileWriter outputFile(outputFileName);
 
-        if (!outputFile) {
+        if (!outputFile.isOpen()) {
             return false;
         }
 
-        outputFile.write(reinterpret_cast<char *>(inputData.data()), inputData.size());
+        outputFile.write(inputData);
         outputFile.close();
     } catch (const std::exception &e) {
         return false;
@@ -62,25 +598,23 @@ bool TransformationAlgorithms::encodeFile(const std::string &inputFileName, cons
 bool TransformationAlgorithms::decodeFile(const std::string &inputFileName, const std::string &outputFileName,
         std::function<void(std::vector<uint8_t> &data)> decodeAlgorithm)
 {
-    std::ifstream inputFile(inputFileName, std::ios::binary);
+    FileReader inputFile(inputFileName);
 
-    if (!inputFile) {
+    if (!inputFile.isOpen()) {
         return false;
     }
 
-    std::vector<uint8_t> encodedData((std::istreambuf_iterator<char>(inputFile)),
-                                     std::istreambuf_iterator<char>());
-    inputFile.close();
-
     try {
+        std::vector<uint8_t> encodedData;
+        inputFile.readAll(encodedData);
         decodeAlgorithm(encodedData);
-        std::ofstream outputFile(outputFileName, std::ios::binary);
+        FileWriter outputFile(outputFileName);
 
-        if (!outputFile) {
+        if (!outputFile.isOpen()) {
             return false;
         }
 
-        outputFile.write(reinterpret_cast<char *>(encodedData.data()), encodedData.size());
+        outputFile.write(encodedData);
         outputFile.close();
     } catch (const std::exception &e) {
         return false;
@@ -89,53 +623,86 @@ bool TransformationAlgorithms::decodeFile(const std::string &inputFileName, cons
     return true;
 }
 
-void TransformationAlgorithms::encodeWithBWT(std::vector<uint8_t> &data)
+bool TransformationAlgorithms::transformMappedFile(const std::string &inputFileName,
+        const std::string &outputFileName,
+        std::function<std::vector<uint8_t>(const ByteView &data)> transformAlgorithm)
 {
-    std::vector<uint8_t> encodedData;
-    size_t len = data.size();
+    MappedFile inputFile(inputFileName);
 
-    if (len == 0) {
-        return encodedData.swap(data);
+    if (!inputFile.isOpen()) {
+        return false;
     }
 
-    std::vector<size_t> indices(len);
+    try {
+        std::vector<uint8_t> outputData = transformAlgorithm(inputFile.view());
+        FileWriter outputFile(outputFileName);
 
-    for (size_t i = 0; i < len; ++i) {
-        indices[i] = i;
+        if (!outputFile.isOpen()) {
+            return false;
+        }
+
+        outputFile.write(outputData);
+        outputFile.close();
+    } catch (const std::exception &e) {
+        return false;
     }
 
-    auto compare = [&data, len](size_t a, size_t b) {
-        for (size_t i = 0; i < len; ++i) {
-            uint8_t ac = data[(a + i) % len];
-            uint8_t bc = data[(b + i) % len];
+    return true;
+}
 
-            if (ac != bc) {
-                return ac < bc;
-            }
-        }
+bool TransformationAlgorithms::transformFileInChunks(const std::string &inputFileName,
+        const std::string &outputFileName,
+        std::function<void(std::vector<uint8_t> &chunk, bool last)> chunkAlgorithm)
+{
+    FileReader inputFile(inputFileName);
 
+    if (!inputFile.isOpen()) {
         return false;
-    };
+    }
 
-    std::sort(indices.begin(), indices.end(), compare);
+    try {
+        FileWriter outputFile(outputFileName);
 
-    encodedData.resize(len + sizeof(uint32_t));
-    uint32_t originalIndex = 0;
+        if (!outputFile.isOpen()) {
+            return false;
+        }
 
-    for (size_t i = 0; i < len; ++i) {
-        size_t idx = (indices[i] + len - 1) % len;
-        encodedData[sizeof(uint32_t) + i] = data[idx];
+        std::vector<uint8_t> chunk;
 
-        if (indices[i] == 0) {
-            originalIndex = static_cast<uint32_t>(i);
+        while (inputFile.readChunk(chunk)) {
+            chunkAlgorithm(chunk, false);
+            outputFile.write(chunk);
         }
+
+        chunk.clear();
+        chunkAlgorithm(chunk, true);
+        outputFile.write(chunk);
+        outputFile.close();
+    } catch (const std::exception &e) {
+        return false;
+    }
+
+    return true;
+}
+
+void TransformationAlgorithms::encodeWithBWT(std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> encodedData;
+    size_t len = data.size();
+
+    if (len == 0) {
+        return encodedData.swap(data);
+    }
+
+    if (len > UINT32_MAX) {
+        throw std::runtime_error("Data is too large for BWT!");
     }
 
-    encodedData[0] = static_cast<uint8_t>(originalIndex & 0xFF);
-    encodedData[1] = static_cast<uint8_t>((originalIndex >> 8) & 0xFF);
-    encodedData[2] = static_cast<uint8_t>((originalIndex >> 16) & 0xFF);
-    encodedData[3] = static_cast<uint8_t>((originalIndex >> 24) & 0xFF);
+    encodedData.resize(len + sizeof(uint32_t));
+    size_t originalIndex = 0;
+    encodeBlockWithBWT(data.data(), len, &encodedData[sizeof(uint32_t)], &originalIndex, 1);
 
+    putUint32(&encodedData[0], static_cast<uint32_t>(originalIndex));
     data.swap(encodedData);
 }
 
@@ -144,77 +711,192 @@ void TransformationAlgorithms::decodeWithBWT(std::vector<uint8_t> &encodedData)
     std::vector<uint8_t> data;
     size_t totalLen = encodedData.size();
 
-    if (totalLen <= sizeof(uint32_t)) {
+    // Empty data encodes to nothing, anything else has an index and a byte
+    if (totalLen == 0) {
         return;
     }
 
-    size_t len = totalLen - sizeof(uint32_t);
+    if (totalLen <= sizeof(uint32_t)) {
+        throw std::runtime_error("Data format is wrong!");
+    }
 
-    uint32_t originalIndex = static_cast<uint32_t>(encodedData[0])
-                             | (static_cast<uint32_t>(encodedData[1]) << 8)
-                             | (static_cast<uint32_t>(encodedData[2]) << 16)
-                             | (static_cast<uint32_t>(encodedData[3]) << 24);
+    size_t len = totalLen - sizeof(uint32_t);
+    size_t originalIndex = getUint32(&encodedData[0]);
 
-    const uint8_t *lastColumn = &encodedData[sizeof(uint32_t)];
+    if (originalIndex >= len) {
+        throw std::runtime_error("Data format is wrong!");
+    }
 
-    std::vector<int> count(256, 0);
+    data.resize(len);
+    decodeBlockWithBWT(&encodedData[sizeof(uint32_t)], len, &originalIndex, 1, data.data());
+    encodedData.swap(data);
+}
 
-    for (size_t i = 0; i < len; ++i) {
-        count[lastColumn[i]]++;
+void TransformationAlgorithms::encodeWithBlockedBWT(std::vector<uint8_t> &data, size_t blockSize,
+        unsigned threadCount)
+{
+    if (blockSize == 0 || blockSize > UINT32_MAX) {
+        throw std::runtime_error("Invalid BWT block size!");
     }
 
-    std::vector<int> cumulativeCount(256, 0);
-    cumulativeCount[0] = 0;
+    ThreadPool pool(threadCount);
+    std::vector<uint8_t> encodedData(sizeof(BlockedBWTMagic) + blockedBWTSize(data.size(), blockSize));
+    std::copy(BlockedBWTMagic, BlockedBWTMagic + sizeof(BlockedBWTMagic), encodedData.begin());
+    encodeBlocksWithBWT(data.data(), data.size(), blockSize, pool, &encodedData[sizeof(BlockedBWTMagic)]);
+    data.swap(encodedData);
+}
 
-    for (int i = 1; i < 256; ++i) {
-        cumulativeCount[i] = cumulativeCount[i - 1] + count[i - 1];
+void TransformationAlgorithms::decodeWithBlockedBWT(std::vector<uint8_t> &encodedData, unsigned threadCount)
+{
+    if (encodedData.size() < sizeof(BlockedBWTMagic)
+        || !std::equal(BlockedBWTMagic, BlockedBWTMagic + sizeof(BlockedBWTMagic), encodedData.begin())) {
+        throw std::runtime_error("Data format is wrong!");
     }
 
-    std::vector<int> tally(256, 0);
-    std::vector<int> LF(len);
+    const uint8_t *blocks = encodedData.data() + sizeof(BlockedBWTMagic);
+    size_t decodedSize = 0;
+    std::vector<size_t> blockOffsets = scanBlockedBWT(blocks, encodedData.size() - sizeof(BlockedBWTMagic),
+                                       decodedSize);
 
-    for (size_t i = 0; i < len; ++i) {
-        uint8_t ch = lastColumn[i];
-        LF[i] = cumulativeCount[ch] + tally[ch];
-        tally[ch]++;
-    }
+    ThreadPool pool(threadCount);
+    std::vector<uint8_t> data(decodedSize);
+    decodeBlocksWithBWT(blocks, blockOffsets, pool, data.data());
+    encodedData.swap(data);
+}
 
-    data.resize(len);
-    int idx = originalIndex;
+void TransformationAlgorithms::encodeBlocksWithBWT(const uint8_t *data, size_t size, size_t blockSize,
+        ThreadPool &pool, uint8_t *encodedData)
+{
+    size_t blockCount = (size + blockSize - 1) / blockSize;
 
-    for (size_t i = 0; i < len; ++i) {
-        data[len - i - 1] = lastColumn[idx];
-        idx = LF[idx];
-    }
+    pool.parallelFor(blockCount, [&](size_t block) {
+        size_t offset = block * blockSize;
+        size_t len = std::min(blockSize, size - offset);
+        uint8_t *header = encodedData + offset + block * BlockedBWTHeaderSize;
+        size_t startRows[BlockedBWTStreams];
+        encodeBlockWithBWT(data + offset, len, header + BlockedBWTHeaderSize, startRows, BlockedBWTStreams);
 
-    encodedData.swap(data);
+        putUint32(header, static_cast<uint32_t>(len));
+
+        for (size_t stream = 0; stream < BlockedBWTStreams; ++stream) {
+            putUint32(header + (1 + stream) * sizeof(uint32_t), static_cast<uint32_t>(startRows[stream]));
+        }
+    });
+}
+
+void TransformationAlgorithms::decodeBlocksWithBWT(const uint8_t *encodedData,
+        const std::vector<size_t> &blockOffsets, ThreadPool &pool, uint8_t *data)
+{
+    pool.parallelFor(blockOffsets.size(), [&](size_t block) {
+        const uint8_t *header = encodedData + blockOffsets[block];
+        size_t len = getUint32(header);
+        size_t outputOffset = blockOffsets[block] - block * BlockedBWTHeaderSize;
+        size_t startRows[BlockedBWTStreams];
+
+        for (size_t stream = 0; stream < BlockedBWTStreams; ++stream) {
+            startRows[stream] = getUint32(header + (1 + stream) * sizeof(uint32_t));
+        }
+
+        decodeBlockWithBWT(header + BlockedBWTHeaderSize, len, startRows, BlockedBWTStreams, data + outputOffset);
+    });
 }
 
 void TransformationAlgorithms::encodeWithDelta(std::vector<uint8_t> &data)
 {
     uint8_t previous = 0;
+    encodeChunkWithDelta(data, previous);
+}
 
-    for (size_t i = 0; i < data.size(); ++i) {
-        uint8_t current = data[i];
-        data[i] = current - previous;
+void TransformationAlgorithms::decodeWithDelta(std::vector<uint8_t> &encodedData)
+{
+    uint8_t previous = 0;
+    decodeChunkWithDelta(encodedData, previous);
+}
+
+void TransformationAlgorithms::encodeChunkWithDelta(std::vector<uint8_t> &chunk, uint8_t &previous)
+{
+    for (size_t i = 0; i < chunk.size(); ++i) {
+        uint8_t current = chunk[i];
+        chunk[i] = current - previous;
         previous = current;
     }
 }
 
-void TransformationAlgorithms::decodeWithDelta(std::vector<uint8_t> &encodedData)
+void TransformationAlgorithms::decodeChunkWithDelta(std::vector<uint8_t> &chunk, uint8_t &previous)
 {
-    uint8_t previous = 0;
+    for (size_t i = 0; i < chunk.size(); ++i) {
+        chunk[i] = chunk[i] + previous;
+        previous = chunk[i];
+    }
+}
 
-    for (size_t i = 0; i < encodedData.size(); ++i) {
-        encodedData[i] = encodedData[i] + previous;
-        previous = encodedData[i];
+void TransformationAlgorithms::encodeWithStrideDelta(std::vector<uint8_t> &data, uint32_t stride, uint32_t order)
+{
+    std::vector<uint8_t> encodedData = encodeViewWithStrideDelta(data, stride, order);
+    data = std::move(encodedData);
+}
+
+void TransformationAlgorithms::decodeWithStrideDelta(std::vector<uint8_t> &encodedData)
+{
+    std::vector<uint8_t> decodedData = decodeViewWithStrideDelta(encodedData);
+    encodedData = std::move(decodedData);
+}
+
+std::vector<uint8_t> TransformationAlgorithms::encodeViewWithStrideDelta(const ByteView &data, uint32_t stride,
+        uint32_t order)
+{
+    if (stride == 0 || order == 0 || order > UINT8_MAX) {
+        throw std::runtime_error("Invalid delta stride or order!");
+    }
+
+    std::vector<uint8_t> encodedData(StrideDeltaHeaderSize + data.size());
+    std::copy(StrideDeltaMagic, StrideDeltaMagic + 4, encodedData.begin());
+    putUint32(&encodedData[4], stride);
+    encodedData[8] = static_cast<uint8_t>(order);
+    std::copy(data.begin(), data.end(), encodedData.begin() + StrideDeltaHeaderSize);
+
+    for (uint32_t i = 0; i < order; ++i) {
+        encodeStrideDelta(encodedData.data() + StrideDeltaHeaderSize, data.size(), stride);
+    }
+
+    return encodedData;
+}
+
+std::vector<uint8_t> TransformationAlgorithms::decodeViewWithStrideDelta(const ByteView &encodedData)
+{
+    uint32_t stride;
+    uint32_t order;
+    getStrideDeltaHeader(encodedData, stride, order);
+
+    std::vector<uint8_t> data(encodedData.begin() + StrideDeltaHeaderSize, encodedData.end());
+
+    for (uint32_t i = 0; i < order; ++i) {
+        decodeStrideDelta(data.data(), data.size(), stride);
+    }
+
+    return data;
+}
+
+void TransformationAlgorithms::getStrideDeltaHeader(const ByteView &encodedData, uint32_t &stride, uint32_t &order)
+{
+    if (encodedData.size() < StrideDeltaHeaderSize
+        || !std::equal(StrideDeltaMagic, StrideDeltaMagic + 4, encodedData.begin())) {
+        throw std::runtime_error("Invalid delta header!");
+    }
+
+    stride = getUint32(encodedData.data() + 4);
+    order = encodedData[8];
+
+    if (stride == 0) {
+        throw std::runtime_error("Invalid delta header!");
     }
 }
 
 void TransformationAlgorithms::encodeWithCube(std::vector<uint8_t> &data)
 {
     size_t dataSize = data.size();
-    std::vector<uint8_t> encodedData(dataSize);
+    // The tail shorter than a cube is kept as it is
+    std::vector<uint8_t> encodedData(data);
 
     for (size_t i = 0; i + 64 <= dataSize; i += 64) {
         for (size_t j = 0; j < 64; ++j) {
@@ -223,13 +905,13 @@ void TransformationAlgorithms::encodeWithCube(std::vector<uint8_t> &data)
         }
     }
 
-    data = encodedData;
+    data = std::move(encodedData);
 }
 
 void TransformationAlgorithms::decodeWithCube(std::vector<uint8_t> &encodedData)
 {
     size_t dataSize = encodedData.size();
-    std::vector<uint8_t> decodedData(dataSize);
+    std::vector<uint8_t> decodedData(encodedData);
 
     for (size_t i = 0; i + 64 <= dataSize; i += 64) {
         for (size_t j = 0; j < 64; ++j) {
@@ -238,7 +920,7 @@ void TransformationAlgorithms::decodeWithCube(std::vector<uint8_t> &encodedData)
         }
     }
 
-    encodedData = decodedData;
+    encodedData = std::move(decodedData);
 }
 
 void TransformationAlgorithms::encodeWithComplement(std::vector<uint8_t> &data)
@@ -291,6 +973,18 @@ void TransformationAlgorithms::decodeWithComplement(std::vector<uint8_t> &encode
 }
 
 void TransformationAlgorithms::encodeWithBlockSort(std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> encodedData = encodeViewWithBlockSort(data);
+    data.swap(encodedData);
+}
+
+void TransformationAlgorithms::decodeWithBlockSort(std::vector<uint8_t> &encodedData)
+{
+    std::vector<uint8_t> decodedData = decodeViewWithBlockSort(encodedData);
+    encodedData.swap(decodedData);
+}
+
+std::vector<uint8_t> TransformationAlgorithms::encodeViewWithBlockSort(const ByteView &data)
 {
     std::vector<uint8_t> encodedData;
     const size_t blockSize = 256;
@@ -337,10 +1031,10 @@ void TransformationAlgorithms::encodeWithBlockSort(std::vector<uint8_t> &data)
         encodedData.insert(encodedData.end(), data.begin() + dataIndex, data.end());
     }
 
-    data.swap(encodedData);
+    return encodedData;
 }
 
-void TransformationAlgorithms::decodeWithBlockSort(std::vector<uint8_t> &encodedData)
+std::vector<uint8_t> TransformationAlgorithms::decodeViewWithBlockSort(const ByteView &encodedData)
 {
     std::vector<uint8_t> decodedData;
     const size_t blockSize = 256;
@@ -355,7 +1049,7 @@ void TransformationAlgorithms::decodeWithBlockSort(std::vector<uint8_t> &encoded
         for (size_t i = 0; i < 32; ++i) {
             if (dataIndex >= dataSize) {
                 std::cerr << "Data format is wrong!" << std::endl;
-                return;
+                return std::vector<uint8_t>(encodedData.begin(), encodedData.end());
             }
 
             uint8_t byte = encodedData[dataIndex++];
@@ -371,7 +1065,7 @@ void TransformationAlgorithms::decodeWithBlockSort(std::vector<uint8_t> &encoded
 
         if (dataIndex + numChanges > dataSize) {
             std::cerr << "Data format is wrong!" << std::endl;
-            return;
+            return std::vector<uint8_t>(encodedData.begin(), encodedData.end());
         }
 
         std::vector<uint8_t> changedValues(encodedData.begin() + dataIndex, encodedData.begin() + dataIndex + numChanges);
@@ -394,7 +1088,7 @@ void TransformationAlgorithms::decodeWithBlockSort(std::vector<uint8_t> &encoded
         decodedData.insert(decodedData.end(), encodedData.begin() + dataIndex, encodedData.end());
     }
 
-    encodedData.swap(decodedData);
+    return decodedData;
 }
 
 void TransformationAlgorithms::encodeWithPB(std::vector<uint8_t> &data)
@@ -491,7 +1185,7 @@ void TransformationAlgorithms::decodeWithPB(std::vector<uint8_t> &encodedData)
     }
 }
 
-void TransformationAlgorithms::encodeWithMTF(std::vector<uint8_t> &data)
+std::vector<uint8_t> TransformationAlgorithms::initialMTFDictionary()
 {
     std::vector<uint8_t> dict(256);
 
@@ -499,119 +1193,337 @@ void TransformationAlgorithms::encodeWithMTF(std::vector<uint8_t> &data)
         dict[i] = static_cast<uint8_t>(i);
     }
 
+    return dict;
+}
+
+void TransformationAlgorithms::encodeWithMTF(std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> dict = initialMTFDictionary();
+    encodeChunkWithMTF(data, dict);
+}
+
+void TransformationAlgorithms::decodeWithMTF(std::vector<uint8_t> &encodedData)
+{
+    std::vector<uint8_t> dict = initialMTFDictionary();
+    decodeChunkWithMTF(encodedData, dict);
+}
+
+void TransformationAlgorithms::encodeChunkWithMTF(std::vector<uint8_t> &chunk, std::vector<uint8_t> &dict)
+{
+    alignas(16) uint8_t table[256];
+    std::copy(dict.begin(), dict.end(), table);
+    encodeMTF(table, chunk.data(), chunk.size());
+    std::copy(table, table + 256, dict.begin());
+}
+
+void TransformationAlgorithms::decodeChunkWithMTF(std::vector<uint8_t> &chunk, std::vector<uint8_t> &dict)
+{
+    alignas(16) uint8_t table[256];
+    std::copy(dict.begin(), dict.end(), table);
+    decodeMTF(table, chunk.data(), chunk.size());
+    std::copy(table, table + 256, dict.begin());
+}
+
+void TransformationAlgorithms::encodeWithRLE(std::vector<uint8_t> &data)
+{
+    RLEState state;
+    encodeChunkWithRLE(data, state, true);
+}
+
+void TransformationAlgorithms::decodeWithRLE(std::vector<uint8_t> &encodedData)
+{
+    RLEState state;
+    decodeChunkWithRLE(encodedData, state);
+}
+
+void TransformationAlgorithms::encodeChunkWithRLE(std::vector<uint8_t> &chunk, RLEState &state, bool last)
+{
     std::vector<uint8_t> encoded;
-    encoded.reserve(data.size());
+    encoded.reserve(chunk.size());
 
-    for (uint8_t symbol : data) {
-        auto it = std::find(dict.begin(), dict.end(), symbol);
-        int index = static_cast<int>(std::distance(dict.begin(), it));
+    for (uint8_t symbol : chunk) {
+        if (state.pending && symbol == state.symbol && state.count < 255) {
+            state.count++;
+        } else {
+            if (state.pending) {
+                encoded.push_back(state.count);
+                encoded.push_back(state.symbol);
+            }
 
-        encoded.push_back(static_cast<uint8_t>(index));
+            state.symbol = symbol;
+            state.count = 1;
+            state.pending = true;
+        }
+    }
 
-        dict.erase(dict.begin() + index);
-        dict.insert(dict.begin(), symbol);
+    if (last && state.pending) {
+        encoded.push_back(state.count);
+        encoded.push_back(state.symbol);
+        state.pending = false;
     }
 
-    data = std::move(encoded);
+    chunk = std::move(encoded);
 }
 
-void TransformationAlgorithms::decodeWithMTF(std::vector<uint8_t> &encodedData)
+void TransformationAlgorithms::decodeChunkWithRLE(std::vector<uint8_t> &chunk, RLEState &state)
 {
-    std::vector<uint8_t> dict(256);
+    std::vector<uint8_t> decoded;
+    decoded.reserve(chunk.size() * 2);
+    size_t i = 0;
 
-    for (int i = 0; i < 256; i++) {
-        dict[i] = static_cast<uint8_t>(i);
+    if (state.pending && !chunk.empty()) {
+        decoded.insert(decoded.end(), state.count, chunk[0]);
+        state.pending = false;
+        i = 1;
     }
 
-    std::vector<uint8_t> decoded;
-    decoded.reserve(encodedData.size());
+    for (; i + 1 < chunk.size(); i += 2) {
+        decoded.insert(decoded.end(), chunk[i], chunk[i + 1]);
+    }
 
-    for (uint8_t index : encodedData) {
-        uint8_t symbol = dict[index];
-        decoded.push_back(symbol);
-        dict.erase(dict.begin() + index);
-        dict.insert(dict.begin(), symbol);
+    if (i < chunk.size()) {
+        state.count = chunk[i];
+        state.pending = true;
     }
 
-    encodedData = std::move(decoded);
+    chunk = std::move(decoded);
 }
 
-void TransformationAlgorithms::encodeWithRLE(std::vector<uint8_t> &data)
+void TransformationAlgorithms::encodeWithThresholdRLE(std::vector<uint8_t> &data)
 {
-    if (data.empty()) {
-        return;
-    }
+    std::vector<uint8_t> encodedData = encodeViewWithThresholdRLE(data);
+    data = std::move(encodedData);
+}
 
-    std::vector<uint8_t> encoded;
-    encoded.reserve(data.size());
+void TransformationAlgorithms::decodeWithThresholdRLE(std::vector<uint8_t> &encodedData)
+{
+    std::vector<uint8_t> decodedData = decodeViewWithThresholdRLE(encodedData);
+    encodedData = std::move(decodedData);
+}
 
-    uint8_t count = 1;
-    uint8_t currentSymbol = data[0];
+std::vector<uint8_t> TransformationAlgorithms::encodeViewWithThresholdRLE(const ByteView &data)
+{
+    std::vector<uint8_t> encodedData;
+    encodedData.reserve(data.size() + data.size() / 4 + 1);
 
-    for (size_t i = 1; i < data.size(); i++) {
-        if (data[i] == currentSymbol && count < 255) {
-            count++;
-        } else {
-            encoded.push_back(count);
-            encoded.push_back(currentSymbol);
-            currentSymbol = data[i];
-            count = 1;
+    const uint8_t *input = data.data();
+    size_t size = data.size();
+    size_t pos = 0;
+
+    while (pos < size) {
+        size_t runStart = pos + findRunStart(input + pos, size - pos);
+        encodedData.insert(encodedData.end(), input + pos, input + runStart);
+        pos = runStart;
+
+        if (pos == size) {
+            break;
         }
+
+        size_t run = std::min(runLength(input + pos, size - pos), RLEMaxRun);
+        encodedData.insert(encodedData.end(), RLERunThreshold, input[pos]);
+        encodedData.push_back(static_cast<uint8_t>(run - RLERunThreshold));
+        pos += run;
     }
 
-    encoded.push_back(count);
-    encoded.push_back(currentSymbol);
-    data = std::move(encoded);
+    return encodedData;
 }
 
-void TransformationAlgorithms::decodeWithRLE(std::vector<uint8_t> &encodedData)
+std::vector<uint8_t> TransformationAlgorithms::decodeViewWithThresholdRLE(const ByteView &encodedData)
 {
-    std::vector<uint8_t> decoded;
+    std::vector<uint8_t> decodedData;
+    decodedData.reserve(encodedData.size() * 2);
+
+    const uint8_t *input = encodedData.data();
+    size_t size = encodedData.size();
+    size_t pos = 0;
 
-    for (size_t i = 0; i + 1 < encodedData.size(); i += 2) {
-        uint8_t count = encodedData[i];
-        uint8_t symbol = encodedData[i + 1];
+    while (pos < size) {
+        size_t runStart = pos + findRunStart(input + pos, size - pos);
 
-        for (int j = 0; j < count; j++) {
-            decoded.push_back(symbol);
+        if (runStart == size) {
+            decodedData.insert(decodedData.end(), input + pos, input + size);
+            break;
         }
+
+        // Four equal bytes are always followed by their repeat count
+        size_t countPos = runStart + RLERunThreshold;
+        decodedData.insert(decodedData.end(), input + pos, input + countPos);
+
+        if (countPos == size) {
+            throw std::runtime_error("Invalid threshold RLE data!");
+        }
+
+        decodedData.insert(decodedData.end(), input[countPos], input[runStart]);
+        pos = countPos + 1;
     }
 
-    encodedData = std::move(decoded);
+    return decodedData;
 }
 
 bool TransformationAlgorithms::encodeFileWithBWT(const std::string &inputFileName, const std::string &outputFileName)
 {
-    return encodeFile(inputFileName, outputFileName, &TransformationAlgorithms::encodeWithBWT);
+    MappedFile inputFile(inputFileName);
+
+    if (!inputFile.isOpen() || inputFile.size() > UINT32_MAX) {
+        return false;
+    }
+
+    try {
+        size_t len = inputFile.size();
+        MappedFile outputFile(outputFileName, (len == 0) ? 0 : len + sizeof(uint32_t));
+
+        if (!outputFile.isOpen()) {
+            return false;
+        }
+
+        if (len > 0) {
+            size_t originalIndex = 0;
+            encodeBlockWithBWT(inputFile.data(), len, outputFile.data() + sizeof(uint32_t), &originalIndex, 1);
+            putUint32(outputFile.data(), static_cast<uint32_t>(originalIndex));
+        }
+
+        outputFile.close();
+    } catch (const std::exception &e) {
+        return false;
+    }
+
+    return true;
 }
 
 bool TransformationAlgorithms::decodeFileWithBWT(const std::string &inputFileName, const std::string &outputFileName)
 {
-    return decodeFile(inputFileName, outputFileName, &TransformationAlgorithms::decodeWithBWT);
+    MappedFile inputFile(inputFileName);
+
+    if (!inputFile.isOpen()) {
+        return false;
+    }
+
+    if (inputFile.size() <= sizeof(uint32_t)) {
+        return transformMappedFile(inputFileName, outputFileName, [](const ByteView & encodedData) {
+            return std::vector<uint8_t>(encodedData.begin(), encodedData.end());
+        });
+    }
+
+    try {
+        size_t len = inputFile.size() - sizeof(uint32_t);
+        size_t originalIndex = getUint32(inputFile.data());
+
+        if (originalIndex >= len) {
+            return false;
+        }
+
+        MappedFile outputFile(outputFileName, len);
+
+        if (!outputFile.isOpen()) {
+            return false;
+        }
+
+        decodeBlockWithBWT(inputFile.data() + sizeof(uint32_t), len, &originalIndex, 1, outputFile.data());
+        outputFile.close();
+    } catch (const std::exception &e) {
+        return false;
+    }
+
+    return true;
+}
+
+bool TransformationAlgorithms::encodeFileWithBlockedBWT(const std::string &inputFileName,
+        const std::string &outputFileName, size_t blockSize, unsigned threadCount)
+{
+    if (blockSize == 0 || blockSize > UINT32_MAX) {
+        return false;
+    }
+
+    MappedFile inputFile(inputFileName);
+
+    if (!inputFile.isOpen()) {
+        return false;
+    }
+
+    try {
+        size_t size = inputFile.size();
+        MappedFile outputFile(outputFileName, sizeof(BlockedBWTMagic) + blockedBWTSize(size, blockSize));
+
+        if (!outputFile.isOpen()) {
+            return false;
+        }
+
+        ThreadPool pool(threadCount);
+        std::copy(BlockedBWTMagic, BlockedBWTMagic + sizeof(BlockedBWTMagic), outputFile.data());
+        encodeBlocksWithBWT(inputFile.data(), size, blockSize, pool, outputFile.data() + sizeof(BlockedBWTMagic));
+        outputFile.close();
+    } catch (const std::exception &e) {
+        return false;
+    }
+
+    return true;
+}
+
+bool TransformationAlgorithms::decodeFileWithBlockedBWT(const std::string &inputFileName,
+        const std::string &outputFileName, unsigned threadCount)
+{
+    MappedFile inputFile(inputFileName);
+
+    if (!inputFile.isOpen() || inputFile.size() < sizeof(BlockedBWTMagic)
+        || !std::equal(BlockedBWTMagic, BlockedBWTMagic + sizeof(BlockedBWTMagic), inputFile.data())) {
+        return false;
+    }
+
+    try {
+        const uint8_t *blocks = inputFile.data() + sizeof(BlockedBWTMagic);
+        size_t decodedSize = 0;
+        std::vector<size_t> blockOffsets = scanBlockedBWT(blocks, inputFile.size() - sizeof(BlockedBWTMagic),
+                                           decodedSize);
+        MappedFile outputFile(outputFileName, decodedSize);
+
+        if (!outputFile.isOpen()) {
+            return false;
+        }
+
+        ThreadPool pool(threadCount);
+        decodeBlocksWithBWT(blocks, blockOffsets, pool, outputFile.data());
+        outputFile.close();
+    } catch (const std::exception &e) {
+        return false;
+    }
+
+    return true;
 }
 
 bool TransformationAlgorithms::encodeFileWithDelta(const std::string &inputFileName,
         const std::string &outputFileName)
 {
-    return encodeFile(inputFileName, outputFileName, &TransformationAlgorithms::encodeWithDelta);
+    uint8_t previous = 0;
+
+    return transformFileInChunks(inputFileName, outputFileName, [&previous](std::vector<uint8_t> &chunk, bool) {
+        encodeChunkWithDelta(chunk, previous);
+    });
 }
 
 bool TransformationAlgorithms::decodeFileWithDelta(const std::string &inputFileName,
         const std::string &outputFileName)
 {
-    return decodeFile(inputFileName, outputFileName, &TransformationAlgorithms::decodeWithDelta);
+    uint8_t previous = 0;
+
+    return transformFileInChunks(inputFileName, outputFileName, [&previous](std::vector<uint8_t> &chunk, bool) {
+        decodeChunkWithDelta(chunk, previous);
+    });
 }
 
 bool TransformationAlgorithms::encodeFileWithCube(const std::string &inputFileName,
         const std::string &outputFileName)
 {
-    return encodeFile(inputFileName, outputFileName, &TransformationAlgorithms::encodeWithCube);
+    return transformFileInChunks(inputFileName, outputFileName, [](std::vector<uint8_t> &chunk, bool) {
+        encodeWithCube(chunk);
+    });
 }
 
 bool TransformationAlgorithms::decodeFileWithCube(const std::string &inputFileName,
         const std::string &outputFileName)
 {
-    return decodeFile(inputFileName, outputFileName, &TransformationAlgorithms::decodeWithCube);
+    return transformFileInChunks(inputFileName, outputFileName, [](std::vector<uint8_t> &chunk, bool) {
+        decodeWithCube(chunk);
+    });
 }
 
 bool TransformationAlgorithms::encodeFileWithComplement(const std::string &inputFileName,
@@ -629,13 +1541,13 @@ bool TransformationAlgorithms::decodeFileWithComplement(const std::string &input
 bool TransformationAlgorithms::encodeFileWithBlockSort(const std::string &inputFileName,
         const std::string &outputFileName)
 {
-    return encodeFile(inputFileName, outputFileName, &TransformationAlgorithms::encodeWithBlockSort);
+    return transformMappedFile(inputFileName, outputFileName, &TransformationAlgorithms::encodeViewWithBlockSort);
 }
 
 bool TransformationAlgorithms::decodeFileWithBlockSort(const std::string &inputFileName,
         const std::string &outputFileName)
 {
-    return decodeFile(inputFileName, outputFileName, &TransformationAlgorithms::decodeWithBlockSort);
+    return transformMappedFile(inputFileName, outputFileName, &TransformationAlgorithms::decodeViewWithBlockSort);
 }
 
 bool TransformationAlgorithms::encodeFileWithPB(const std::string &inputFileName, const std::string &outputFileName)
@@ -650,20 +1562,62 @@ bool TransformationAlgorithms::decodeFileWithPB(const std::string &inputFileName
 
 bool TransformationAlgorithms::encodeFileWithMTF(const std::string &inputFileName, const std::string &outputFileName)
 {
-    return encodeFile(inputFileName, outputFileName, &TransformationAlgorithms::encodeWithMTF);
+    std::vector<uint8_t> dict = initialMTFDictionary();
+
+    return transformFileInChunks(inputFileName, outputFileName, [&dict](std::vector<uint8_t> &chunk, bool) {
+        encodeChunkWithMTF(chunk, dict);
+    });
 }
 
 bool TransformationAlgorithms::decodeFileWithMTF(const std::string &inputFileName, const std::string &outputFileName)
 {
-    return decodeFile(inputFileName, outputFileName, &TransformationAlgorithms::decodeWithMTF);
+    std::vector<uint8_t> dict = initialMTFDictionary();
+
+    return transformFileInChunks(inputFileName, outputFileName, [&dict](std::vector<uint8_t> &chunk, bool) {
+        decodeChunkWithMTF(chunk, dict);
+    });
 }
 
 bool TransformationAlgorithms::encodeFileWithRLE(const std::string &inputFileName, const std::string &outputFileName)
 {
-    return encodeFile(inputFileName, outputFileName, &TransformationAlgorithms::encodeWithRLE);
+    RLEState state;
+
+    return transformFileInChunks(inputFileName, outputFileName, [&state](std::vector<uint8_t> &chunk, bool last) {
+        encodeChunkWithRLE(chunk, state, last);
+    });
 }
 
 bool TransformationAlgorithms::decodeFileWithRLE(const std::string &inputFileName, const std::string &outputFileName)
 {
-    return decodeFile(inputFileName, outputFileName, &TransformationAlgorithms::decodeWithRLE);
+    RLEState state;
+
+    return transformFileInChunks(inputFileName, outputFileName, [&state](std::vector<uint8_t> &chunk, bool) {
+        decodeChunkWithRLE(chunk, state);
+    });
+}
+
+bool TransformationAlgorithms::encodeFileWithStrideDelta(const std::string &inputFileName,
+        const std::string &outputFileName, uint32_t stride, uint32_t order)
+{
+    return transformMappedFile(inputFileName, outputFileName, [stride, order](const ByteView &data) {
+        return encodeViewWithStrideDelta(data, stride, order);
+    });
+}
+
+bool TransformationAlgorithms::decodeFileWithStrideDelta(const std::string &inputFileName,
+        const std::string &outputFileName)
+{
+    return transformMappedFile(inputFileName, outputFileName, &TransformationAlgorithms::decodeViewWithStrideDelta);
+}
+
+bool TransformationAlgorithms::encodeFileWithThresholdRLE(const std::string &inputFileName,
+        const std::string &outputFileName)
+{
+    return transformMappedFile(inputFileName, outputFileName, &TransformationAlgorithms::encodeViewWithThresholdRLE);
+}
+
+bool TransformationAlgorithms::decodeFileWithThresholdRLE(const std::string &inputFileName,
+        const std::string &outputFileName)
+{
+    return transformMappedFile(inputFileName, outputFileName, &TransformationAlgorithms::decodeViewWithThresholdRLE);
 }
@@ -12,19 +12,35 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <cstdint>
+
+#include "byteview.h"
+
+class ThreadPool;
 
 class TransformationAlgorithms
 {
 public:
+    static const size_t DefaultBWTBlockSize = 8 * 1024 * 1024;
+
     TransformationAlgorithms();
     ~TransformationAlgorithms();
 
     bool encodeFileWithBWT(const std::string &inputFileName, const std::string &outputFileName);
     bool decodeFileWithBWT(const std::string &inputFileName, const std::string &outputFileName);
 
+    bool encodeFileWithBlockedBWT(const std::string &inputFileName, const std::string &outputFileName,
+                                  size_t blockSize = DefaultBWTBlockSize, unsigned threadCount = 0);
+    bool decodeFileWithBlockedBWT(const std::string &inputFileName, const std::string &outputFileName,
+                                  unsigned threadCount = 0);
+
     bool encodeFileWithDelta(const std::string &inputFileName, const std::string &outputFileName);
     bool decodeFileWithDelta(const std::string &inputFileName, const std::string &outputFileName);
 
+    bool encodeFileWithStrideDelta(const std::string &inputFileName, const std::string &outputFileName,
+                                   uint32_t stride = 1, uint32_t order = 1);
+    bool decodeFileWithStrideDelta(const std::string &inputFileName, const std::string &outputFileName);
+
     bool encodeFileWithCube(const std::string &inputFileName, const std::string &outputFileName);
     bool decodeFileWithCube(const std::string &inputFileName, const std::string &outputFileName);
 
@@ -43,13 +59,30 @@ public:
     bool encodeFileWithRLE(const std::string &inputFileName, const std::string &outputFileName);
     bool decodeFileWithRLE(const std::string &inputFileName, const std::string &outputFileName);
 
+    bool encodeFileWithThresholdRLE(const std::string &inputFileName, const std::string &outputFileName);
+    bool decodeFileWithThresholdRLE(const std::string &inputFileName, const std::string &outputFileName);
+
 protected:
     static void encodeWithBWT(std::vector<uint8_t> &data);
     static void decodeWithBWT(std::vector<uint8_t> &encodedData);
 
+    static void encodeWithBlockedBWT(std::vector<uint8_t> &data, size_t blockSize = DefaultBWTBlockSize,
+                                     unsigned threadCount = 0);
+    static void decodeWithBlockedBWT(std::vector<uint8_t> &encodedData, unsigned threadCount = 0);
+
     static void encodeWithDelta(std::vector<uint8_t> &data);
     static void decodeWithDelta(std::vector<uint8_t> &encodedData);
 
+    // Subtracts the byte stride positions back, order times over. The
+    // stride and order are stored in a header.
+    static void encodeWithStrideDelta(std::vector<uint8_t> &data, uint32_t stride = 1, uint32_t order = 1);
+    static void decodeWithStrideDelta(std::vector<uint8_t> &encodedData);
+    static std::vector<uint8_t> encodeViewWithStrideDelta(const ByteView &data, uint32_t stride = 1,
+            uint32_t order = 1);
+    static std::vector<uint8_t> decodeViewWithStrideDelta(const ByteView &encodedData);
+    // Reads the stride and order of encoded data, throws on an invalid header
+    static void getStrideDeltaHeader(const ByteView &encodedData, uint32_t &stride, uint32_t &order);
+
     static void encodeWithCube(std::vector<uint8_t> &data);
     static void decodeWithCube(std::vector<uint8_t> &encodedData);
 
@@ -58,6 +91,8 @@ protected:
 
     static void encodeWithBlockSort(std::vector<uint8_t> &data);
     static void decodeWithBlockSort(std::vector<uint8_t> &encodedData);
+    static std::vector<uint8_t> encodeViewWithBlockSort(const ByteView &data);
+    static std::vector<uint8_t> decodeViewWithBlockSort(const ByteView &encodedData);
 
     static void encodeWithPB(std::vector<uint8_t> &data);
     static void decodeWithPB(std::vector<uint8_t> &encodedData);
@@ -68,11 +103,50 @@ protected:
     static void encodeWithRLE(std::vector<uint8_t> &data);
     static void decodeWithRLE(std::vector<uint8_t> &encodedData);
 
+    // Runs of four or more bytes become four bytes and a repeat count,
+    // shorter ones are copied as they are
+    static void encodeWithThresholdRLE(std::vector<uint8_t> &data);
+    static void decodeWithThresholdRLE(std::vector<uint8_t> &encodedData);
+    static std::vector<uint8_t> encodeViewWithThresholdRLE(const ByteView &data);
+    static std::vector<uint8_t> decodeViewWithThresholdRLE(const ByteView &encodedData);
+
+    struct RLEState {
+        uint8_t count = 0;
+        uint8_t symbol = 0;
+        bool pending = false;
+    };
+
+    // Chunk kernels carry their state between calls, so a stream split into
+    // chunks gives the same output as the whole buffer at once
+    static void encodeChunkWithDelta(std::vector<uint8_t> &chunk, uint8_t &previous);
+    static void decodeChunkWithDelta(std::vector<uint8_t> &chunk, uint8_t &previous);
+
+    static std::vector<uint8_t> initialMTFDictionary();
+    static void encodeChunkWithMTF(std::vector<uint8_t> &chunk, std::vector<uint8_t> &dict);
+    static void decodeChunkWithMTF(std::vector<uint8_t> &chunk, std::vector<uint8_t> &dict);
+
+    static void encodeChunkWithRLE(std::vector<uint8_t> &chunk, RLEState &state, bool last);
+    static void decodeChunkWithRLE(std::vector<uint8_t> &chunk, RLEState &state);
+
 private:
+    static void encodeBlockWithBWT(const uint8_t *block, size_t len, uint8_t *lastColumn, size_t *startRows,
+                                   size_t streamCount);
+    static void decodeBlockWithBWT(const uint8_t *lastColumn, size_t len, const size_t *startRows,
+                                   size_t streamCount, uint8_t *block);
+
+    static void encodeBlocksWithBWT(const uint8_t *data, size_t size, size_t blockSize, ThreadPool &pool,
+                                    uint8_t *encodedData);
+    static void decodeBlocksWithBWT(const uint8_t *encodedData, const std::vector<size_t> &blockOffsets,
+                                    ThreadPool &pool, uint8_t *data);
+
     bool encodeFile(const std::string &inputFileName, const std::string &outputFileName,
                     std::function<void(std::vector<uint8_t> &)> encodeAlgorithm);
     bool decodeFile(const std::string &inputFileName, const std::string &outputFileName,
                     std::function<void(std::vector<uint8_t> &)> decodeAlgorithm);
+    bool transformMappedFile(const std::string &inputFileName, const std::string &outputFileName,
+                             std::function<std::vector<uint8_t>(const ByteView &)> transformAlgorithm);
+    bool transformFileInChunks(const std::string &inputFileName, const std::string &outputFileName,
+                               std::function<void(std::vector<uint8_t> &, bool)> chunkAlgorithm);
 };
 
 #endif // TRANSFORMATIONALGORITHMS_H